@@ -0,0 +1,246 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "async_logger.hpp"
+
+#include <algorithm>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+std::atomic<std::uint64_t> gNextLoggerId{0};
+
+} // namespace
+
+
+AsyncLogger::AsyncLogger(
+  std::ostream& stream,
+  const std::size_t queueCapacityPerThread
+)
+  : mpStream(&stream)
+  , mQueueCapacityPerThread(queueCapacityPerThread)
+  , mId(gNextLoggerId.fetch_add(1, std::memory_order_relaxed))
+  , mThread([this]() { run(); })
+{
+}
+
+
+AsyncLogger::~AsyncLogger()
+{
+  mStopRequested.store(true, std::memory_order_release);
+  mThread.join();
+}
+
+
+std::uint64_t AsyncLogger::numDroppedRecords() const
+{
+  std::lock_guard<std::mutex> lock{mQueuesMutex};
+
+  auto total = mNumDroppedInReleasedQueues;
+  for (const auto& pQueue : mQueues)
+  {
+    total += pQueue->mNumDropped.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+
+void AsyncLogger::write(const LogFormat format, const LogArguments& arguments)
+{
+  auto& queue = queueForThisThread();
+
+  if (!queue.mRecords.tryPush(Record{format, arguments}))
+  {
+    queue.mNumDropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+
+auto AsyncLogger::queueForThisThread() -> ThreadQueue&
+{
+  // Single entry cache, so that the common case of a thread logging to one
+  // logger doesn't need to take the lock. On a miss, the thread may still
+  // have a queue from before it last switched loggers.
+  //
+  // Also marks the thread as exited when it is destroyed, which allows the
+  // loggers to release the thread's queues.
+  struct CachedQueue
+  {
+    ~CachedQueue()
+    {
+      mpThread->mHasExited.store(true, std::memory_order_release);
+    }
+
+    std::shared_ptr<ThreadState> mpThread = std::make_shared<ThreadState>();
+    std::uint64_t mLoggerId = ~std::uint64_t{0};
+    ThreadQueue* mpQueue = nullptr;
+  };
+
+  thread_local CachedQueue cache;
+
+  if (cache.mLoggerId != mId)
+  {
+    const auto pThisThread = cache.mpThread.get();
+
+    std::lock_guard<std::mutex> lock{mQueuesMutex};
+
+    const auto iQueue = std::find_if(mQueues.begin(), mQueues.end(),
+      [pThisThread](const std::unique_ptr<ThreadQueue>& pQueue)
+      {
+        return pQueue->mpOwner.get() == pThisThread;
+      });
+
+    if (iQueue != mQueues.end())
+    {
+      cache.mpQueue = iQueue->get();
+    }
+    else
+    {
+      mQueues.push_back(std::make_unique<ThreadQueue>(
+        cache.mpThread, mQueueCapacityPerThread));
+      cache.mpQueue = mQueues.back().get();
+    }
+
+    cache.mLoggerId = mId;
+  }
+
+  return *cache.mpQueue;
+}
+
+
+void AsyncLogger::run()
+{
+  for (;;)
+  {
+    // Read the flag before draining, so that nothing logged before the
+    // destructor was called gets lost.
+    const auto stopRequested = mStopRequested.load(std::memory_order_acquire);
+
+    if (!writeBatch())
+    {
+      if (stopRequested)
+      {
+        break;
+      }
+
+      std::this_thread::sleep_for(FLUSH_INTERVAL);
+    }
+  }
+}
+
+
+bool AsyncLogger::writeBatch()
+{
+  mBuffer.str({});
+
+  auto numRecords = std::size_t{0};
+  auto numDropped = std::uint64_t{0};
+
+  {
+    // Queues are only removed by this thread, so it's safe to use them after
+    // releasing the lock. Formatting without holding it keeps threads which
+    // log for the first time from waiting on the I/O.
+    std::lock_guard<std::mutex> lock{mQueuesMutex};
+
+    numDropped = mNumDroppedInReleasedQueues;
+
+    mQueuesSnapshot.clear();
+    for (const auto& pQueue : mQueues)
+    {
+      mQueuesSnapshot.push_back(pQueue.get());
+    }
+  }
+
+  mDrainedQueues.clear();
+
+  for (const auto pQueue : mQueuesSnapshot)
+  {
+    // Checked before draining: Once the owner has exited, nothing is pushed
+    // anymore, and popping up to the capacity empties the queue.
+    if (pQueue->mpOwner->mHasExited.load(std::memory_order_acquire))
+    {
+      mDrainedQueues.push_back(pQueue);
+    }
+
+    numRecords += pQueue->mRecords.popBatch(
+      [this](const Record& record)
+      {
+        record.mFormat(mBuffer, record.mArguments);
+      },
+      pQueue->mRecords.capacity());
+
+    numDropped += pQueue->mNumDropped.load(std::memory_order_relaxed);
+  }
+
+  if (numDropped != mNumReportedDropped)
+  {
+    mBuffer << "[" << numDropped - mNumReportedDropped <<
+      " log records dropped]\n";
+    mNumReportedDropped = numDropped;
+  }
+
+  const auto text = mBuffer.str();
+  if (!text.empty())
+  {
+    mpStream->write(text.data(), static_cast<std::streamsize>(text.size()));
+    mpStream->flush();
+  }
+
+  releaseQueuesOfExitedThreads();
+
+  return numRecords > 0;
+}
+
+
+void AsyncLogger::releaseQueuesOfExitedThreads()
+{
+  if (mDrainedQueues.empty())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{mQueuesMutex};
+
+  const auto iFirstReleased = std::remove_if(mQueues.begin(), mQueues.end(),
+    [this](const std::unique_ptr<ThreadQueue>& pQueue)
+    {
+      const auto wasDrained = std::find(
+        mDrainedQueues.begin(), mDrainedQueues.end(), pQueue.get()) !=
+          mDrainedQueues.end();
+
+      if (wasDrained)
+      {
+        mNumDroppedInReleasedQueues +=
+          pQueue->mNumDropped.load(std::memory_order_relaxed);
+      }
+
+      return wasDrained;
+    });
+
+  mQueues.erase(iFirstReleased, mQueues.end());
+}
+
+} // namespace variant_talk
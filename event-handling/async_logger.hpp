@@ -0,0 +1,134 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event_queue.hpp"
+#include "log_sink.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Log sink which moves formatting and I/O off the logging threads.
+//
+// Each thread which logs gets its own bounded queue of unformatted records.
+// Logging only copies the format id and arguments into that queue, and never
+// blocks: if the queue is full, the record is dropped and counted instead. A
+// background thread periodically collects the records from all queues,
+// formats them into a buffer and writes that to the stream in one go.
+//
+// Records from the same thread are written in order, but records from
+// different threads may be interleaved differently than they were logged.
+// Dropped records are reported in the output as they are noticed. Once a
+// thread has exited and its queue has been drained, the queue is released, so
+// short-lived threads don't accumulate queues. Threads must not log from
+// destructors of thread_local objects.
+class AsyncLogger : public LogSink
+{
+public:
+  explicit AsyncLogger(
+    std::ostream& stream,
+    std::size_t queueCapacityPerThread = 8192);
+
+  // Writes all records which are still queued before returning
+  ~AsyncLogger() override;
+
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  std::uint64_t numDroppedRecords() const;
+
+protected:
+  void write(LogFormat format, const LogArguments& arguments) override;
+
+private:
+  struct Record
+  {
+    LogFormat mFormat = nullptr;
+    LogArguments mArguments{};
+  };
+
+  // One per logging thread, shared by the queues of all loggers it logs to.
+  // Set when the thread exits, after its last record has been pushed.
+  struct ThreadState
+  {
+    std::atomic<bool> mHasExited{false};
+  };
+
+  struct ThreadQueue
+  {
+    ThreadQueue(
+      std::shared_ptr<const ThreadState> pOwner,
+      const std::size_t capacity)
+      : mpOwner(std::move(pOwner))
+      , mRecords(capacity)
+    {
+    }
+
+    const std::shared_ptr<const ThreadState> mpOwner;
+    BoundedMpscQueue<Record> mRecords;
+    std::atomic<std::uint64_t> mNumDropped{0};
+  };
+
+  ThreadQueue& queueForThisThread();
+  void run();
+  bool writeBatch();
+  void releaseQueuesOfExitedThreads();
+
+  static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds{2};
+
+  std::ostream* mpStream;
+  const std::size_t mQueueCapacityPerThread;
+
+  // Distinguishes logger instances in the per-thread queue lookup, even if a
+  // new one is created at the address of a destroyed one
+  const std::uint64_t mId;
+
+  mutable std::mutex mQueuesMutex;
+  std::vector<std::unique_ptr<ThreadQueue>> mQueues;
+
+  // Drop counts of queues which have been released, guarded by mQueuesMutex
+  std::uint64_t mNumDroppedInReleasedQueues = 0;
+
+  // Only accessed by the background thread
+  std::vector<ThreadQueue*> mQueuesSnapshot;
+  std::vector<const ThreadQueue*> mDrainedQueues;
+  std::ostringstream mBuffer;
+  std::uint64_t mNumReportedDropped = 0;
+
+  std::atomic<bool> mStopRequested{false};
+  std::thread mThread;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,103 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "wakeup_signal.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+
+namespace variant_talk
+{
+
+enum class BackOffStrategy
+{
+  // Busy-wait. Lowest latency, but occupies a core while waiting.
+  Spin,
+
+  // Spin briefly, then yield the CPU to other threads between attempts.
+  Yield,
+
+  // Spin and yield briefly, then sleep until woken up via a WakeupSignal.
+  Block
+};
+
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+
+// Waits until isReady() returns true, using the given strategy. For
+// BackOffStrategy::Block, whoever makes the condition true has to call
+// notifyAll() on the given signal afterwards.
+template <typename Condition>
+void waitUntil(
+  Condition&& isReady,
+  const BackOffStrategy strategy,
+  WakeupSignal& signal)
+{
+  constexpr auto NUM_SPINS = 64;
+  constexpr auto NUM_YIELDS = 16;
+
+  // Stops counting once past the spin and yield phases, since waiting with the
+  // Spin and Yield strategies isn't bounded.
+  for (auto attempt = 0; !isReady();
+       attempt = std::min(attempt + 1, NUM_SPINS + NUM_YIELDS))
+  {
+    if (strategy == BackOffStrategy::Spin || attempt < NUM_SPINS)
+    {
+      cpuRelax();
+    }
+    else if (
+      strategy == BackOffStrategy::Yield ||
+      attempt < NUM_SPINS + NUM_YIELDS)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      const auto ticket = signal.prepareWait();
+      if (isReady())
+      {
+        signal.cancelWait();
+        return;
+      }
+
+      signal.wait(ticket);
+    }
+  }
+}
+
+} // namespace variant_talk
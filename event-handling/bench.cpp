@@ -0,0 +1,752 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Headless throughput and latency benchmark for ExampleEventHandler.
+//
+// Feeds synthetic events into the handler, either as fast as possible or at
+// a fixed rate, and reports events per second, latency percentiles and heap
+// allocations per event.
+//
+// The handler's output goes to one of the following sinks:
+//
+//   null     - formatted, then discarded
+//   disabled - a stream in failed state, which skips formatting altogether
+//   stdout   - written to standard output
+//
+// Comparing null and disabled yields the cost of formatting, comparing null
+// and stdout the cost of the I/O itself. With --log async, formatting and I/O
+// happen on a background thread (see AsyncLogger).
+//
+// With --dispatch bus or static, events are published through an EventBus or
+// StaticEventBus, to which a dozen single-type subscribers are attached in
+// addition to the handler. With --dispatch sharded, events are spread across
+// several handler threads by a ShardedDispatcher. With --dispatch coroutine
+// (only in builds with VARIANT_TALK_COROUTINES), the CoroutineEventHandler
+// replaces the handler. --work adds a busy wait to each handled event, to
+// simulate handlers which do real work.
+//
+// With --record, the synthetic events are written to an event log instead
+// (see event_log.hpp), and with --replay, the events are taken from such a
+// log, e.g. a trace recorded by the event_handling example.
+
+#include "async_logger.hpp"
+#include "event_bus.hpp"
+#include "event_generator.hpp"
+#include "event_log.hpp"
+#include "handler.hpp"
+#include "sharded_dispatcher.hpp"
+
+#include "match.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+// Only allocations on the benchmark's own thread are of interest, not those of
+// e.g. the asynchronous logger's background thread.
+thread_local std::uint64_t tNumAllocations = 0;
+
+} // namespace
+
+
+void* operator new(const std::size_t size)
+{
+  ++tNumAllocations;
+
+  if (auto pMemory = std::malloc(size == 0 ? 1 : size))
+  {
+    return pMemory;
+  }
+
+  throw std::bad_alloc{};
+}
+
+
+void operator delete(void* pMemory) noexcept
+{
+  std::free(pMemory);
+}
+
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+  std::free(pMemory);
+}
+
+
+using namespace variant_talk;
+
+namespace
+{
+
+namespace cr = std::chrono;
+using Clock = cr::steady_clock;
+
+
+class NullBuffer : public std::streambuf
+{
+protected:
+  int_type overflow(const int_type character) override
+  {
+    return traits_type::not_eof(character);
+  }
+
+  std::streamsize xsputn(const char*, const std::streamsize count) override
+  {
+    return count;
+  }
+};
+
+
+enum class Sink
+{
+  Null,
+  Disabled,
+  Stdout
+};
+
+
+enum class Dispatch
+{
+  Direct,
+  Bus,
+  Static,
+  Sharded,
+  Coroutine
+};
+
+
+constexpr std::size_t SHARD_QUEUE_CAPACITY = 4096;
+
+
+struct Options
+{
+  std::uint64_t mNumEvents = 1'000'000;
+  double mEventsPerSecond = 0.0; // 0 means as fast as possible
+  EventMix mMix;
+  Sink mSink = Sink::Null;
+  bool mUseAsyncLog = false;
+  Dispatch mDispatch = Dispatch::Direct;
+  std::size_t mNumShards = std::max(std::thread::hardware_concurrency(), 1u);
+  cr::nanoseconds mWorkPerEvent{0};
+  std::uint32_t mSeed = 0;
+
+  std::string mRecordPath;
+  std::string mReplayPath;
+  ReplaySpeed mReplaySpeed = ReplaySpeed::Original;
+};
+
+
+// ExampleEventHandler, optionally followed by a busy wait to simulate
+// handlers which do real work.
+//
+// Unless a shared log is given, each instance logs through its own stream on
+// top of the given buffer, so that instances can run on different threads.
+template <typename Handler = ExampleEventHandler>
+class BenchHandler
+{
+public:
+  BenchHandler(
+    std::streambuf* pOutputBuffer,
+    LogSink* pSharedLog,
+    const cr::nanoseconds workPerEvent)
+    : mOutput(pOutputBuffer)
+    , mStreamLog(mOutput)
+    , mHandler(pSharedLog ? *pSharedLog : mStreamLog)
+    , mWorkPerEvent(workPerEvent)
+  {
+  }
+
+  void onEvent(const Event& event)
+  {
+    mHandler.onEvent(event);
+
+    if (mWorkPerEvent.count() > 0)
+    {
+      const auto workEnd = Clock::now() + mWorkPerEvent;
+      while (Clock::now() < workEnd)
+      {
+      }
+    }
+  }
+
+private:
+  std::ostream mOutput;
+  StreamLogSink mStreamLog;
+  Handler mHandler;
+  cr::nanoseconds mWorkPerEvent;
+};
+
+
+// Stand-ins for additional subscribers, each of which is only interested in a
+// single event type.
+template <typename T>
+struct CountingSubscriber
+{
+  void operator()(const T&)
+  {
+    ++*mpCount;
+  }
+
+  std::uint64_t* mpCount;
+};
+
+
+constexpr std::size_t NUM_COUNTING_SUBSCRIBERS = 12;
+
+using MakeCounterIndices = std::make_index_sequence<NUM_COUNTING_SUBSCRIBERS>;
+
+template <std::size_t Index>
+using CountedEventType =
+  std::tuple_element_t<Index % Event::alternative_count, std::tuple<
+    event::MouseMoved,
+    event::MouseButtonDown,
+    event::MouseButtonUp,
+    event::WindowResized>>;
+
+
+template <std::size_t... Indices>
+void subscribeCounters(
+  EventBus<Event>& bus,
+  std::array<std::uint64_t, NUM_COUNTING_SUBSCRIBERS>& counts,
+  std::index_sequence<Indices...>)
+{
+  (bus.subscribe<CountedEventType<Indices>>(
+    CountingSubscriber<CountedEventType<Indices>>{&counts[Indices]}), ...);
+}
+
+
+template <typename Handler, std::size_t... Indices>
+auto makeStaticEventBus(
+  Handler handler,
+  std::array<std::uint64_t, NUM_COUNTING_SUBSCRIBERS>& counts,
+  std::index_sequence<Indices...>)
+{
+  return StaticEventBus<
+    Handler,
+    CountingSubscriber<CountedEventType<Indices>>...>{
+      handler,
+      CountingSubscriber<CountedEventType<Indices>>{&counts[Indices]}...};
+}
+
+
+std::optional<EventMix> parseMix(const std::string& spec)
+{
+  EventMix mix;
+  char separator1 = 0;
+  char separator2 = 0;
+
+  std::istringstream stream{spec};
+  stream >> mix.mMoves >> separator1 >> mix.mClicks >> separator2 >>
+    mix.mResizes;
+
+  if (!stream || separator1 != ',' || separator2 != ',')
+  {
+    return std::nullopt;
+  }
+
+  return mix;
+}
+
+
+std::optional<Sink> parseSink(std::string_view name)
+{
+  if (name == "null")
+  {
+    return Sink::Null;
+  }
+  else if (name == "disabled")
+  {
+    return Sink::Disabled;
+  }
+  else if (name == "stdout")
+  {
+    return Sink::Stdout;
+  }
+
+  return std::nullopt;
+}
+
+
+std::optional<Dispatch> parseDispatch(std::string_view name)
+{
+  if (name == "direct")
+  {
+    return Dispatch::Direct;
+  }
+  else if (name == "bus")
+  {
+    return Dispatch::Bus;
+  }
+  else if (name == "static")
+  {
+    return Dispatch::Static;
+  }
+  else if (name == "sharded")
+  {
+    return Dispatch::Sharded;
+  }
+#if defined(VARIANT_TALK_COROUTINES)
+  else if (name == "coroutine")
+  {
+    return Dispatch::Coroutine;
+  }
+#endif
+
+  return std::nullopt;
+}
+
+
+// Throws std::invalid_argument or std::out_of_range for malformed numbers
+std::optional<Options> parseArguments(const int argc, char** argv)
+{
+  Options options;
+
+  for (auto i = 1; i + 1 < argc; i += 2)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string{argv[i + 1]};
+
+    if (arg == "--events")
+    {
+      options.mNumEvents = std::stoull(value);
+      if (options.mNumEvents == 0)
+      {
+        return std::nullopt;
+      }
+    }
+    else if (arg == "--rate")
+    {
+      options.mEventsPerSecond = std::stod(value);
+    }
+    else if (arg == "--seed")
+    {
+      options.mSeed = static_cast<std::uint32_t>(std::stoul(value));
+    }
+    else if (arg == "--log" && (value == "sync" || value == "async"))
+    {
+      options.mUseAsyncLog = value == "async";
+    }
+    else if (arg == "--dispatch")
+    {
+      const auto dispatch = parseDispatch(value);
+      if (!dispatch)
+      {
+        return std::nullopt;
+      }
+
+      options.mDispatch = *dispatch;
+    }
+    else if (arg == "--shards")
+    {
+      options.mNumShards = std::max<std::size_t>(std::stoul(value), 1);
+    }
+    else if (arg == "--work")
+    {
+      options.mWorkPerEvent = cr::nanoseconds{std::stoll(value)};
+    }
+    else if (arg == "--record")
+    {
+      options.mRecordPath = value;
+    }
+    else if (arg == "--replay")
+    {
+      options.mReplayPath = value;
+    }
+    else if (arg == "--replay-speed" && (value == "original" || value == "max"))
+    {
+      options.mReplaySpeed =
+        value == "max" ? ReplaySpeed::Maximum : ReplaySpeed::Original;
+    }
+    else if (arg == "--mix")
+    {
+      const auto mix = parseMix(value);
+      if (!mix)
+      {
+        return std::nullopt;
+      }
+
+      options.mMix = *mix;
+    }
+    else if (arg == "--sink")
+    {
+      const auto sink = parseSink(value);
+      if (!sink)
+      {
+        return std::nullopt;
+      }
+
+      options.mSink = *sink;
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (argc % 2 == 0)
+  {
+    // Dangling option without value
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+
+std::optional<Options> parseOptions(const int argc, char** argv)
+{
+  try
+  {
+    return parseArguments(argc, argv);
+  }
+  catch (const std::logic_error&)
+  {
+    return std::nullopt;
+  }
+}
+
+
+double percentile(const std::vector<double>& sortedValues, const double p)
+{
+  if (sortedValues.empty())
+  {
+    return 0.0;
+  }
+
+  const auto index = static_cast<std::size_t>(
+    p / 100.0 * static_cast<double>(sortedValues.size() - 1));
+  return sortedValues[index];
+}
+
+
+template <typename Records, typename Dispatch, typename Finish>
+void measure(
+  Dispatch&& dispatch,
+  Finish&& finish,
+  const Records& records,
+  const std::size_t numRecords,
+  const bool isPaced)
+{
+  std::vector<double> latencies;
+  latencies.reserve(numRecords);
+
+  const auto allocationsBefore = tNumAllocations;
+  const auto start = Clock::now();
+
+  for (const auto& record : records)
+  {
+    // In paced mode, latency is measured from the time the event was supposed
+    // to arrive, so it includes any backlog if the handler can't keep up.
+    auto arrivalTime = Clock::now();
+    if (isPaced)
+    {
+      const auto scheduledTime = start +
+        cr::duration_cast<Clock::duration>(record.mTimestamp);
+      while (arrivalTime < scheduledTime)
+      {
+        arrivalTime = Clock::now();
+      }
+
+      arrivalTime = scheduledTime;
+    }
+
+    dispatch(record.mEvent);
+
+    latencies.push_back(
+      cr::duration<double, std::nano>{Clock::now() - arrivalTime}.count());
+  }
+
+  finish();
+
+  const auto elapsed = cr::duration<double>{Clock::now() - start}.count();
+  const auto numAllocations = tNumAllocations - allocationsBefore;
+
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto numEvents = static_cast<double>(latencies.size());
+
+  auto& report = std::cerr;
+  report << std::fixed << std::setprecision(1)
+    << "events:             " << latencies.size() << '\n'
+    << "elapsed:            " << std::setprecision(3) << elapsed << " s\n"
+    << std::setprecision(1)
+    << "throughput:         " << numEvents / elapsed << " events/s\n"
+    << "latency p50:        " << percentile(latencies, 50.0) << " ns\n"
+    << "latency p90:        " << percentile(latencies, 90.0) << " ns\n"
+    << "latency p99:        " << percentile(latencies, 99.0) << " ns\n"
+    << "latency p99.9:      " << percentile(latencies, 99.9) << " ns\n"
+    << "latency max:        " << percentile(latencies, 100.0) << " ns\n"
+    << std::setprecision(3)
+    << "allocations/event:  " << static_cast<double>(numAllocations) / numEvents
+    << '\n';
+}
+
+
+std::vector<EventLogRecord> generateEvents(const Options& options)
+{
+  const auto interval = options.mEventsPerSecond > 0.0
+    ? cr::duration_cast<cr::nanoseconds>(
+        cr::duration<double>{1.0 / options.mEventsPerSecond})
+    : cr::nanoseconds{};
+
+  SyntheticEventSource source{options.mMix, options.mSeed};
+  std::vector<EventLogRecord> records;
+  records.reserve(options.mNumEvents);
+
+  for (auto i = std::uint64_t{0}; i < options.mNumEvents; ++i)
+  {
+    records.push_back({interval * static_cast<std::int64_t>(i), source.next()});
+  }
+
+  return records;
+}
+
+
+// finish() is called after the last event was dispatched, and must wait for
+// any asynchronous processing to complete.
+template <typename Dispatch, typename Finish = void (*)()>
+void measureAll(
+  const Options& options,
+  Dispatch&& dispatch,
+  Finish&& finish = []() {})
+{
+  if (!options.mReplayPath.empty())
+  {
+    const EventLogReader log{options.mReplayPath};
+
+    // Also pages in the file, so that the measurement doesn't include disk I/O
+    const auto numRecords =
+      static_cast<std::size_t>(std::distance(log.begin(), log.end()));
+
+    measure(
+      dispatch,
+      finish,
+      log,
+      numRecords,
+      options.mReplaySpeed == ReplaySpeed::Original);
+  }
+  else
+  {
+    // Generate all events up front, so that only the handler is measured.
+    const auto records = generateEvents(options);
+    measure(
+      dispatch,
+      finish,
+      records,
+      records.size(),
+      options.mEventsPerSecond > 0.0);
+  }
+}
+
+
+void run(const Options& options)
+{
+  if (!options.mRecordPath.empty())
+  {
+    EventLogWriter log{options.mRecordPath};
+    for (const auto& record : generateEvents(options))
+    {
+      log.append(record.mEvent, record.mTimestamp);
+    }
+
+    return;
+  }
+
+  NullBuffer nullBuffer;
+
+  // A null buffer makes the stream fail, which disables formatting
+  const auto pOutputBuffer = options.mSink == Sink::Stdout
+    ? std::cout.rdbuf()
+    : (options.mSink == Sink::Null ? &nullBuffer : nullptr);
+
+  std::ostream output{pOutputBuffer};
+
+  std::unique_ptr<AsyncLogger> pAsyncLog;
+  if (options.mUseAsyncLog)
+  {
+    pAsyncLog = std::make_unique<AsyncLogger>(output);
+  }
+
+  BenchHandler<> handler{pOutputBuffer, pAsyncLog.get(), options.mWorkPerEvent};
+  auto forwardToHandler = [&handler](const Event& event)
+  {
+    handler.onEvent(event);
+  };
+
+  std::array<std::uint64_t, NUM_COUNTING_SUBSCRIBERS> counts{};
+
+  if (options.mDispatch == Dispatch::Direct)
+  {
+    measureAll(options, forwardToHandler);
+  }
+  else if (options.mDispatch == Dispatch::Bus)
+  {
+    EventBus<Event> bus;
+    bus.subscribeToAll(forwardToHandler);
+    subscribeCounters(bus, counts, MakeCounterIndices{});
+
+    measureAll(options, [&bus](const Event& event) { bus.publish(event); });
+  }
+  else if (options.mDispatch == Dispatch::Static)
+  {
+    auto bus =
+      makeStaticEventBus(forwardToHandler, counts, MakeCounterIndices{});
+    measureAll(options, [&bus](const Event& event) { bus.publish(event); });
+  }
+#if defined(VARIANT_TALK_COROUTINES)
+  else if (options.mDispatch == Dispatch::Coroutine)
+  {
+    BenchHandler<CoroutineEventHandler> coroutineHandler{
+      pOutputBuffer, pAsyncLog.get(), options.mWorkPerEvent};
+
+    measureAll(
+      options,
+      [&coroutineHandler](const Event& event)
+      {
+        coroutineHandler.onEvent(event);
+      });
+  }
+#endif
+  else
+  {
+    // The synthetic events don't carry a device or window id to shard by, so
+    // this separates mouse moves from button presses and releases instead.
+    // The latter stay in order relative to each other, but can be handled in
+    // parallel with the moves.
+    ShardingPolicy policy;
+    policy.mKeyOf = [](const Event& event) -> std::uint64_t
+    {
+      return event.holds_alternative<event::MouseMoved>() ? 0 : 1;
+    };
+    policy.mIsGlobal = [](const Event& event)
+    {
+      return event.holds_alternative<event::WindowResized>();
+    };
+
+    EventMetrics metrics;
+    ShardedDispatcher<BenchHandler<>> dispatcher{
+      options.mNumShards,
+      [&](std::size_t)
+      {
+        return std::make_unique<BenchHandler<>>(
+          pOutputBuffer, pAsyncLog.get(), options.mWorkPerEvent);
+      },
+      policy,
+      BackOffStrategy::Block,
+      SHARD_QUEUE_CAPACITY,
+      &metrics};
+
+    measureAll(
+      options,
+      [&dispatcher](const Event& event)
+      {
+        dispatcher.dispatch(TimestampedEvent{event, EventClock::now()});
+      },
+      [&dispatcher]() { dispatcher.stop(); });
+
+    // The dispatcher records each global event once, although every shard's
+    // handler sees it.
+    std::cerr << "\ndispatch to handled, per event type\n"
+      "(WindowResized is broadcast to every shard, but counted once):\n";
+    metrics.writeText(std::cerr);
+  }
+
+  if (options.mDispatch == Dispatch::Bus ||
+      options.mDispatch == Dispatch::Static)
+  {
+    std::cerr << "subscriber calls:   "
+      << std::accumulate(counts.begin(), counts.end(), std::uint64_t{0})
+      << '\n';
+  }
+
+  if (pAsyncLog)
+  {
+    std::cerr << "dropped log records: " << pAsyncLog->numDroppedRecords()
+      << '\n';
+  }
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  const auto options = parseOptions(argc, argv);
+  if (!options)
+  {
+    std::cerr <<
+      "Usage: event_handling_bench [--events N] [--rate events_per_second]\n"
+      "                            [--mix moves,clicks,resizes]\n"
+      "                            [--sink null|disabled|stdout] [--seed N]\n"
+      "                            [--log sync|async]\n"
+#if defined(VARIANT_TALK_COROUTINES)
+      "                            [--dispatch direct|bus|static|sharded|\n"
+      "                                        coroutine]\n"
+#else
+      "                            [--dispatch direct|bus|static|sharded]\n"
+#endif
+      "                            [--shards N] [--work ns_per_event]\n"
+      "                            [--record file]\n"
+      "                            [--replay file]\n"
+      "                            [--replay-speed original|max]\n";
+    return 1;
+  }
+
+  try
+  {
+    run(*options);
+  }
+  catch (const std::exception& error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  printMatchStatistics(std::cerr);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "coroutine_frame_pool.hpp"
+
+#include <new>
+
+
+namespace variant_talk
+{
+
+CoroutineFramePool& CoroutineFramePool::forThisThread()
+{
+  thread_local CoroutineFramePool pool;
+  return pool;
+}
+
+
+void* CoroutineFramePool::allocate(const std::size_t size)
+{
+  if (size > MAX_POOLED_SIZE)
+  {
+    return ::operator new(size);
+  }
+
+  const auto sizeClass = sizeClassOf(size);
+  if (!mFreeLists[sizeClass])
+  {
+    addChunk(sizeClass);
+  }
+
+  const auto pBlock = mFreeLists[sizeClass];
+  mFreeLists[sizeClass] = pBlock->mpNext;
+  return pBlock;
+}
+
+
+void CoroutineFramePool::deallocate(void* pFrame, const std::size_t size)
+{
+  if (size > MAX_POOLED_SIZE)
+  {
+    ::operator delete(pFrame);
+    return;
+  }
+
+  const auto sizeClass = sizeClassOf(size);
+  const auto pBlock = static_cast<FreeBlock*>(pFrame);
+  pBlock->mpNext = mFreeLists[sizeClass];
+  mFreeLists[sizeClass] = pBlock;
+}
+
+
+std::size_t CoroutineFramePool::sizeClassOf(const std::size_t size)
+{
+  return size == 0 ? 0 : (size - 1) / SIZE_CLASS_GRANULARITY;
+}
+
+
+void CoroutineFramePool::addChunk(const std::size_t sizeClass)
+{
+  const auto blockSize = (sizeClass + 1) * SIZE_CLASS_GRANULARITY;
+
+  // Blocks are multiples of 64 bytes apart, so they keep the chunk's
+  // alignment, which is suitable for any frame.
+  mChunks.emplace_back(new std::byte[blockSize * BLOCKS_PER_CHUNK]);
+  const auto pChunk = mChunks.back().get();
+
+  for (auto i = std::size_t{0}; i < BLOCKS_PER_CHUNK; ++i)
+  {
+    deallocate(pChunk + i * blockSize, blockSize);
+  }
+}
+
+} // namespace variant_talk
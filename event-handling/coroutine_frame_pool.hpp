@@ -0,0 +1,74 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Allocator for coroutine frames.
+//
+// Frames up to MAX_POOLED_SIZE bytes are carved out of larger chunks and
+// recycled via per size class free lists, so that spawning and finishing
+// coroutines doesn't hit the general purpose heap after warm-up. Larger frames
+// are passed on to the global operator new.
+//
+// Not thread safe: each thread uses its own pool (see forThisThread()), and
+// frames must be freed on the thread which allocated them.
+class CoroutineFramePool
+{
+public:
+  static constexpr std::size_t SIZE_CLASS_GRANULARITY = 64;
+  static constexpr std::size_t MAX_POOLED_SIZE = 1024;
+
+  CoroutineFramePool() = default;
+  CoroutineFramePool(const CoroutineFramePool&) = delete;
+  CoroutineFramePool& operator=(const CoroutineFramePool&) = delete;
+
+  static CoroutineFramePool& forThisThread();
+
+  void* allocate(std::size_t size);
+  void deallocate(void* pFrame, std::size_t size);
+
+private:
+  static constexpr std::size_t NUM_SIZE_CLASSES =
+    MAX_POOLED_SIZE / SIZE_CLASS_GRANULARITY;
+  static constexpr std::size_t BLOCKS_PER_CHUNK = 32;
+
+  struct FreeBlock
+  {
+    FreeBlock* mpNext;
+  };
+
+  static std::size_t sizeClassOf(std::size_t size);
+  void addChunk(std::size_t sizeClass);
+
+  std::array<FreeBlock*, NUM_SIZE_CLASSES> mFreeLists{};
+  std::vector<std::unique_ptr<std::byte[]>> mChunks;
+};
+
+} // namespace variant_talk
@@ -21,7 +21,9 @@
 
 #pragma once
 
-#include <variant>
+#include "compact_variant.hpp"
+
+#include <chrono>
 
 
 namespace variant_talk
@@ -67,10 +69,21 @@ struct WindowResized
 } // namespace event
 
 
-using Event = std::variant<
+using Event = compact_variant<
   event::MouseMoved,
   event::MouseButtonDown,
   event::MouseButtonUp,
   event::WindowResized>;
 
+
+using EventClock = std::chrono::steady_clock;
+
+// An event together with the time it was received from the platform, for
+// measuring latency through the event pipeline.
+struct TimestampedEvent
+{
+  Event mEvent;
+  EventClock::time_point mReceivedAt;
+};
+
 } // namespace variant_talk
@@ -0,0 +1,268 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "match.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Publish/subscribe registry for the alternatives of a variant (e.g. Event).
+//
+// Each alternative has its own list of subscribers. Publishing an event looks
+// up the list for the event's index() in a table, and only invokes the
+// handlers in that list, so handlers which aren't interested in an event
+// type cost nothing when it's published. Subscribers for the same alternative
+// are invoked in the order they subscribed.
+//
+// Handlers must not subscribe or unsubscribe while an event is being
+// published.
+template <typename Variant>
+class EventBus;
+
+
+template <template <typename...> class VariantTemplate, typename... Ts>
+class EventBus<VariantTemplate<Ts...>>
+{
+public:
+  using Variant = VariantTemplate<Ts...>;
+  using SubscriptionId = std::uint64_t;
+
+  // Subscribes handler to the alternative T.
+  template <typename T, typename Handler>
+  SubscriptionId subscribe(Handler&& handler)
+  {
+    static_assert(detail::isOneOf<T, Ts...>, "Type is not an alternative");
+
+    const auto id = mNextId++;
+    std::get<SubscriberList<T>>(mSubscribers).push_back(
+      {id, std::forward<Handler>(handler)});
+    return id;
+  }
+
+  // Subscribes handler to each alternative it can be invoked with. The handler
+  // is copied once per alternative, so copies don't share mutable state.
+  //
+  // Handlers which accept the variant itself (or anything, like a generic
+  // lambda) are rejected: as every alternative converts to the variant, they
+  // would match all of them. Use subscribeToAll() for those.
+  template <typename Handler>
+  SubscriptionId subscribeToMatching(Handler&& handler)
+  {
+    using StoredHandler = std::decay_t<Handler>;
+
+    static_assert(
+      (std::is_invocable_v<StoredHandler&, const Ts&> || ...),
+      "Handler doesn't accept any of the alternatives");
+    static_assert(
+      !std::is_invocable_v<StoredHandler&, const Variant&>,
+      "Handler accepts any event, use subscribeToAll() instead");
+
+    const auto id = mNextId++;
+    (addIfInvocable<Ts>(id, handler), ...);
+    return id;
+  }
+
+  // Subscribes handler to all events, regardless of their type. These
+  // handlers are invoked before the ones for the specific alternative.
+  template <typename Handler>
+  SubscriptionId subscribeToAll(Handler&& handler)
+  {
+    const auto id = mNextId++;
+    mCatchAllSubscribers.push_back({id, std::forward<Handler>(handler)});
+    return id;
+  }
+
+  void unsubscribe(const SubscriptionId id)
+  {
+    removeFrom(mCatchAllSubscribers, id);
+    (removeFrom(std::get<SubscriberList<Ts>>(mSubscribers), id), ...);
+  }
+
+  void publish(const Variant& event) const
+  {
+    for (const auto& subscriber : mCatchAllSubscribers)
+    {
+      subscriber.mHandler(event);
+    }
+
+    using Thunk = void (*)(const EventBus&, const Variant&);
+    static constexpr Thunk thunks[] = {&publishAs<Ts>...};
+
+    thunks[event.index()](*this, event);
+  }
+
+  template <typename T>
+  std::size_t numSubscribers() const
+  {
+    return std::get<SubscriberList<T>>(mSubscribers).size();
+  }
+
+private:
+  template <typename Argument>
+  struct Subscriber
+  {
+    SubscriptionId mId;
+    std::function<void(const Argument&)> mHandler;
+  };
+
+  template <typename Argument>
+  using SubscriberList = std::vector<Subscriber<Argument>>;
+
+  template <typename T>
+  static void publishAs(const EventBus& self, const Variant& event)
+  {
+    const auto& subscribers = std::get<SubscriberList<T>>(self.mSubscribers);
+    if (subscribers.empty())
+    {
+      return;
+    }
+
+    auto invokeAll = [&](const T& alternative)
+    {
+      for (const auto& subscriber : subscribers)
+      {
+        subscriber.mHandler(alternative);
+      }
+    };
+
+    detail::visitAs<T>(invokeAll, event);
+  }
+
+  // Same qualification as in subscribeToMatching(): std::function invokes its
+  // copy of the handler as a non-const lvalue.
+  template <typename T, typename Handler>
+  void addIfInvocable(const SubscriptionId id, const Handler& handler)
+  {
+    if constexpr (std::is_invocable_v<Handler&, const T&>)
+    {
+      std::get<SubscriberList<T>>(mSubscribers).push_back({id, handler});
+    }
+  }
+
+  template <typename Argument>
+  static void removeFrom(
+    SubscriberList<Argument>& subscribers,
+    const SubscriptionId id)
+  {
+    subscribers.erase(
+      std::remove_if(
+        subscribers.begin(),
+        subscribers.end(),
+        [id](const Subscriber<Argument>& subscriber)
+        {
+          return subscriber.mId == id;
+        }),
+      subscribers.end());
+  }
+
+  std::tuple<SubscriberList<Ts>...> mSubscribers;
+  SubscriberList<Variant> mCatchAllSubscribers;
+  SubscriptionId mNextId = 0;
+};
+
+
+// Event bus for a set of handlers which is known at compile time.
+//
+// For each alternative, publish() is compiled into a direct sequence of calls
+// to exactly those handlers which can be invoked with it, in the order the
+// handlers are listed. There is no per-handler indirection, and the calls
+// can be inlined. Handlers which accept the variant itself receive every
+// event, before the handlers for the specific alternative.
+//
+// Handlers are stored by value. To share a handler with other code, wrap it
+// in std::ref.
+template <typename... Handlers>
+class StaticEventBus
+{
+public:
+  explicit StaticEventBus(Handlers... handlers)
+    : mHandlers(std::move(handlers)...)
+  {
+  }
+
+  template <typename Variant>
+  void publish(const Variant& event)
+  {
+    std::apply(
+      [&](auto&... handlers)
+      {
+        (invokeIfAccepts(handlers, event), ...);
+      },
+      mHandlers);
+
+    using std::visit;
+
+    visit(
+      [this](const auto& alternative)
+      {
+        std::apply(
+          [&](auto&... handlers)
+          {
+            (invokeForAlternative<Variant>(handlers, alternative), ...);
+          },
+          mHandlers);
+      },
+      event);
+  }
+
+  template <std::size_t Index>
+  auto& handler()
+  {
+    return std::get<Index>(mHandlers);
+  }
+
+private:
+  template <typename Handler, typename Variant>
+  static void invokeIfAccepts(Handler& handler, const Variant& event)
+  {
+    if constexpr (std::is_invocable_v<Handler&, const Variant&>)
+    {
+      std::invoke(handler, event);
+    }
+  }
+
+  template <typename Variant, typename Handler, typename T>
+  static void invokeForAlternative(Handler& handler, const T& alternative)
+  {
+    if constexpr (
+      !std::is_invocable_v<Handler&, const Variant&> &&
+      std::is_invocable_v<Handler&, const T&>)
+    {
+      std::invoke(handler, alternative);
+    }
+  }
+
+  std::tuple<Handlers...> mHandlers;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,85 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_coalescer.hpp"
+
+#include "match.hpp"
+
+
+namespace variant_talk
+{
+
+EventCoalescer::EventCoalescer(const MouseMoveCoalescing moveCoalescing)
+  : mMoveCoalescing(moveCoalescing)
+{
+}
+
+
+bool EventCoalescer::tryMerge(const Event& event)
+{
+  using namespace event;
+
+  if (!mPending || mPending->mEvent.index() != event.index())
+  {
+    return false;
+  }
+
+  return match(mPending->mEvent,
+    [&](MouseMoved& pendingMove)
+    {
+      const auto move = event.get<MouseMoved>();
+
+      if (mMoveCoalescing == MouseMoveCoalescing::AccumulateDeltas)
+      {
+        pendingMove.x += move.x;
+        pendingMove.y += move.y;
+      }
+      else
+      {
+        pendingMove = move;
+      }
+
+      return true;
+    },
+
+    [&](WindowResized& pendingResize)
+    {
+      pendingResize = event.get<WindowResized>();
+      return true;
+    },
+
+    [](const auto&)
+    {
+      return false;
+    });
+}
+
+
+bool EventCoalescer::isCoalescable(const Event& event)
+{
+  using namespace event;
+
+  return
+    event.holds_alternative<MouseMoved>() ||
+    event.holds_alternative<WindowResized>();
+}
+
+} // namespace variant_talk
@@ -0,0 +1,122 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+
+#include <cstddef>
+#include <optional>
+
+
+namespace variant_talk
+{
+
+enum class MouseMoveCoalescing
+{
+  // Merged moves report the position of the last one
+  KeepLatest,
+
+  // Merged moves report the sum of all moves. For sources which report
+  // relative motion (e.g. raw mouse input) instead of positions.
+  AccumulateDeltas
+};
+
+
+// Pipeline stage which collapses runs of consecutive MouseMoved or
+// WindowResized events into a single event.
+//
+// Events are passed on to a sink, which is any callable accepting a
+// const Event&. A move or resize is held back until an event of a different
+// type arrives, or until flush() is called. All other events are passed on
+// right away, after any held back event, so their order relative to the
+// surrounding moves and resizes is preserved, and they are never dropped.
+//
+// flush() should be called once per frame (or batch of events), so that the
+// number of events reaching the handler depends on the frame rate instead of
+// the input device's polling rate.
+//
+// A merged event keeps the receive time of the first event of its run, so
+// that latency measurements cover the oldest input it represents.
+class EventCoalescer
+{
+public:
+  explicit EventCoalescer(
+    MouseMoveCoalescing moveCoalescing = MouseMoveCoalescing::KeepLatest);
+
+  template <typename Sink>
+  void push(const TimestampedEvent& event, Sink&& sink);
+
+  template <typename Sink>
+  void flush(Sink&& sink);
+
+  // Number of events which were merged into a preceding one
+  std::size_t numMergedEvents() const;
+
+private:
+  bool tryMerge(const Event& event);
+  static bool isCoalescable(const Event& event);
+
+  std::optional<TimestampedEvent> mPending;
+  MouseMoveCoalescing mMoveCoalescing;
+  std::size_t mNumMergedEvents = 0;
+};
+
+
+template <typename Sink>
+void EventCoalescer::push(const TimestampedEvent& event, Sink&& sink)
+{
+  if (tryMerge(event.mEvent))
+  {
+    ++mNumMergedEvents;
+    return;
+  }
+
+  flush(sink);
+
+  if (isCoalescable(event.mEvent))
+  {
+    mPending = event;
+  }
+  else
+  {
+    sink(event);
+  }
+}
+
+
+template <typename Sink>
+void EventCoalescer::flush(Sink&& sink)
+{
+  if (mPending)
+  {
+    sink(*mPending);
+    mPending.reset();
+  }
+}
+
+
+inline std::size_t EventCoalescer::numMergedEvents() const
+{
+  return mNumMergedEvents;
+}
+
+} // namespace variant_talk
@@ -0,0 +1,111 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_consumer.hpp"
+
+
+namespace variant_talk
+{
+
+EventConsumer::EventConsumer(
+  EventQueue& queue,
+  ExampleEventHandler& handler,
+  EventMetrics& metrics,
+  const BackOffStrategy backOffStrategy,
+  const OverloadPolicy& overloadPolicy
+)
+  : mQueue(queue)
+  , mHandler(handler)
+  , mMetrics(metrics)
+  , mBackOffStrategy(backOffStrategy)
+  , mLoadShedder(overloadPolicy)
+  , mThread([this]() { run(); })
+{
+}
+
+
+EventConsumer::~EventConsumer()
+{
+  stop();
+}
+
+
+void EventConsumer::stop()
+{
+  if (!mThread.joinable())
+  {
+    return;
+  }
+
+  mStopRequested.store(true, std::memory_order_release);
+  mQueue.wakeConsumer();
+  mThread.join();
+}
+
+
+void EventConsumer::run()
+{
+  auto handleEvent = [this](const TimestampedEvent& event)
+  {
+    mHandler.onEvent(event.mEvent);
+    mMetrics.recordHandled(event, EventClock::now());
+  };
+
+  auto shedEvent = [this](const TimestampedEvent& event)
+  {
+    mMetrics.recordShed(event);
+  };
+
+  auto processEvent = [&](const TimestampedEvent& event)
+  {
+    mLoadShedder.push(event, mQueue.size(), handleEvent, shedEvent);
+  };
+
+  auto processBatch = [&]()
+  {
+    const auto numProcessed = mQueue.popBatch(processEvent, BATCH_SIZE);
+    mLoadShedder.flush(handleEvent);
+    return numProcessed;
+  };
+
+  for (;;)
+  {
+    if (processBatch() > 0)
+    {
+      continue;
+    }
+
+    if (mStopRequested.load(std::memory_order_acquire))
+    {
+      // Producers are done, but there might still be events which were pushed
+      // right before the stop request.
+      while (processBatch() > 0)
+      {
+      }
+
+      return;
+    }
+
+    mQueue.waitForData(mBackOffStrategy, mStopRequested);
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,82 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "back_off.hpp"
+#include "event.hpp"
+#include "event_metrics.hpp"
+#include "event_queue.hpp"
+#include "handler.hpp"
+#include "load_shedder.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+
+namespace variant_talk
+{
+
+using EventQueue = BoundedMpscQueue<TimestampedEvent>;
+
+
+// Runs a thread which takes events out of the queue in batches, and passes
+// them on to the handler. The latency of each event is recorded in metrics
+// once the handler is done with it.
+//
+// When the handler falls behind, events are shed according to the overload
+// policy (see LoadShedder), and counted in metrics.
+class EventConsumer
+{
+public:
+  EventConsumer(
+    EventQueue& queue,
+    ExampleEventHandler& handler,
+    EventMetrics& metrics,
+    BackOffStrategy backOffStrategy,
+    const OverloadPolicy& overloadPolicy = {});
+  ~EventConsumer();
+
+  EventConsumer(const EventConsumer&) = delete;
+  EventConsumer& operator=(const EventConsumer&) = delete;
+
+  // Handles all events which are already in the queue, then stops the thread.
+  void stop();
+
+private:
+  void run();
+
+  static constexpr std::size_t BATCH_SIZE = 256;
+
+  EventQueue& mQueue;
+  ExampleEventHandler& mHandler;
+  EventMetrics& mMetrics;
+  BackOffStrategy mBackOffStrategy;
+
+  // Only used by the consumer thread
+  LoadShedder mLoadShedder;
+
+  std::atomic<bool> mStopRequested{false};
+  std::thread mThread;
+};
+
+} // namespace variant_talk
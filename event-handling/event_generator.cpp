@@ -0,0 +1,89 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_generator.hpp"
+
+#include <algorithm>
+
+
+namespace variant_talk
+{
+
+SyntheticEventSource::SyntheticEventSource(
+  const EventMix& mix,
+  const std::uint32_t seed
+)
+  : mGenerator(seed)
+  , mKindDistribution({mix.mMoves, mix.mClicks, mix.mResizes})
+{
+}
+
+
+Event SyntheticEventSource::next()
+{
+  using namespace event;
+
+  switch (static_cast<Kind>(mKindDistribution(mGenerator)))
+  {
+    case Kind::Move:
+      mMouseX = std::clamp(mMouseX + randomStep(8), 0, mWindowWidth);
+      mMouseY = std::clamp(mMouseY + randomStep(8), 0, mWindowHeight);
+      return MouseMoved{mMouseX, mMouseY};
+
+    case Kind::Click:
+      if (mButtonIsDown)
+      {
+        mButtonIsDown = false;
+        return MouseButtonUp{mPressedButton};
+      }
+      else
+      {
+        // Mostly left clicks
+        const auto roll = randomInt(0, 9);
+        mPressedButton = roll < 8
+          ? MouseButton::Left
+          : (roll == 8 ? MouseButton::Right : MouseButton::Middle);
+        mButtonIsDown = true;
+        return MouseButtonDown{mPressedButton};
+      }
+
+    case Kind::Resize:
+      mWindowWidth = std::clamp(mWindowWidth + randomStep(4), 100, 4000);
+      mWindowHeight = std::clamp(mWindowHeight + randomStep(4), 100, 4000);
+      return WindowResized{mWindowWidth, mWindowHeight};
+  }
+
+  return MouseMoved{mMouseX, mMouseY};
+}
+
+
+int SyntheticEventSource::randomInt(const int min, const int max)
+{
+  return std::uniform_int_distribution<int>{min, max}(mGenerator);
+}
+
+
+int SyntheticEventSource::randomStep(const int maxStep)
+{
+  return randomInt(-maxStep, maxStep);
+}
+
+} // namespace variant_talk
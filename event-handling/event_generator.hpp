@@ -0,0 +1,75 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+
+#include <cstdint>
+#include <random>
+
+
+namespace variant_talk
+{
+
+// Relative frequencies of the kinds of events a SyntheticEventSource produces.
+// A click produces a MouseButtonDown, and later a matching MouseButtonUp.
+struct EventMix
+{
+  double mMoves = 90.0;
+  double mClicks = 4.0;
+  double mResizes = 6.0;
+};
+
+
+// Produces a deterministic stream of plausible input events: the mouse and
+// the window size follow random walks, and button presses are always followed
+// by the release of the same button.
+class SyntheticEventSource
+{
+public:
+  explicit SyntheticEventSource(const EventMix& mix, std::uint32_t seed = 0);
+
+  Event next();
+
+private:
+  enum class Kind
+  {
+    Move,
+    Click,
+    Resize
+  };
+
+  int randomInt(int min, int max);
+  int randomStep(int maxStep);
+
+  std::mt19937 mGenerator;
+  std::discrete_distribution<int> mKindDistribution;
+
+  int mMouseX = 250;
+  int mMouseY = 250;
+  int mWindowWidth = 500;
+  int mWindowHeight = 500;
+  bool mButtonIsDown = false;
+  MouseButton mPressedButton = MouseButton::Left;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,111 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_log.hpp"
+
+#include <stdexcept>
+
+
+namespace variant_talk
+{
+
+EventLogWriter::EventLogWriter(const std::string& path)
+  : mFile(path, std::ios::binary | std::ios::trunc)
+{
+  if (!mFile)
+  {
+    throw std::runtime_error{"Cannot create event log '" + path + "'"};
+  }
+
+  mFile.write(detail::EVENT_LOG_MAGIC, sizeof(detail::EVENT_LOG_MAGIC));
+}
+
+
+void EventLogWriter::append(
+  const Event& event,
+  const std::chrono::nanoseconds timestamp)
+{
+  // Room for a 64 bit varint, the tag and the largest payload
+  char record[10 + 1 + sizeof(Event)];
+  auto pWrite = record;
+
+  auto delta =
+    static_cast<std::uint64_t>((timestamp - mPreviousTimestamp).count());
+  mPreviousTimestamp = timestamp;
+
+  while (delta >= 0x80u)
+  {
+    *pWrite++ = static_cast<char>((delta & 0x7Fu) | 0x80u);
+    delta >>= 7;
+  }
+  *pWrite++ = static_cast<char>(delta);
+
+  *pWrite++ = static_cast<char>(event.index());
+
+  pWrite = visit(
+    [pWrite](const auto& alternative)
+    {
+      std::memcpy(pWrite, &alternative, sizeof(alternative));
+      return pWrite + sizeof(alternative);
+    },
+    event);
+
+  mFile.write(record, pWrite - record);
+}
+
+
+void EventLogWriter::flush()
+{
+  mFile.flush();
+}
+
+
+EventLogReader::EventLogReader(const std::string& path)
+  : mFile(path)
+{
+  const auto headerSize = sizeof(detail::EVENT_LOG_MAGIC);
+
+  if (
+    mFile.size() < headerSize ||
+    std::memcmp(mFile.data(), detail::EVENT_LOG_MAGIC, headerSize) != 0)
+  {
+    throw std::runtime_error{"'" + path + "' is not an event log"};
+  }
+
+  mFile.adviseSequentialAccess();
+}
+
+
+auto EventLogReader::begin() const -> Iterator
+{
+  return Iterator{
+    mFile.data() + sizeof(detail::EVENT_LOG_MAGIC),
+    mFile.data() + mFile.size()};
+}
+
+
+auto EventLogReader::end() const -> Iterator
+{
+  const auto pEnd = mFile.data() + mFile.size();
+  return Iterator{pEnd, pEnd};
+}
+
+} // namespace variant_talk
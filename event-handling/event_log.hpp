@@ -0,0 +1,272 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+#include "mapped_file.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+
+namespace variant_talk
+{
+
+// Binary log of timestamped events, for recording input traces and replaying
+// them later.
+//
+// The file starts with an 8 byte header (magic and format version), followed
+// by one record per event:
+//
+//   - Nanoseconds since the previous record (or since the start of the
+//     recording, for the first one), as an unsigned LEB128 varint
+//   - The event's alternative index, as one byte
+//   - The alternative's bytes, exactly as they are laid out in memory
+//
+// A mouse move which arrives within a few milliseconds of the previous event
+// thus takes 12 to 13 bytes. The payload uses the host's byte order and
+// struct layout, so logs are only portable between machines which agree on
+// both.
+struct EventLogRecord
+{
+  std::chrono::nanoseconds mTimestamp;
+  Event mEvent;
+};
+
+
+class EventLogWriter
+{
+public:
+  // Throws std::runtime_error if the file can't be created.
+  explicit EventLogWriter(const std::string& path);
+
+  // Timestamps are relative to the start of the recording, and must not
+  // decrease from one call to the next.
+  void append(const Event& event, std::chrono::nanoseconds timestamp);
+
+  void flush();
+
+private:
+  std::ofstream mFile;
+  std::chrono::nanoseconds mPreviousTimestamp{0};
+};
+
+
+// Iterates over the records of a log in place, on top of a memory mapping of
+// the file. Decoding a record doesn't allocate, so arbitrarily long logs can
+// be replayed at a constant memory footprint.
+//
+// A truncated record at the end of the file (e.g. from a recording that was
+// interrupted) ends the iteration.
+class EventLogReader
+{
+public:
+  class Iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = EventLogRecord;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EventLogRecord*;
+    using reference = const EventLogRecord&;
+
+    Iterator(const unsigned char* pNext, const unsigned char* pEnd);
+
+    reference operator*() const
+    {
+      return mRecord;
+    }
+
+    pointer operator->() const
+    {
+      return &mRecord;
+    }
+
+    Iterator& operator++()
+    {
+      decodeNext();
+      return *this;
+    }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+    {
+      return lhs.mpCurrent == rhs.mpCurrent;
+    }
+
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+  private:
+    void decodeNext();
+
+    const unsigned char* mpCurrent;
+    const unsigned char* mpNext;
+    const unsigned char* mpEnd;
+    EventLogRecord mRecord{};
+  };
+
+  // Throws std::runtime_error if the file can't be mapped, or isn't an event
+  // log.
+  explicit EventLogReader(const std::string& path);
+
+  Iterator begin() const;
+  Iterator end() const;
+
+private:
+  MappedFile mFile;
+};
+
+
+enum class ReplaySpeed
+{
+  // Events are delivered at the time they were recorded, relative to the start
+  // of the replay
+  Original,
+
+  // Events are delivered back to back
+  Maximum
+};
+
+
+// Passes each event in the log to a sink, which is any callable accepting a
+// const Event&.
+template <typename Sink>
+void replay(const EventLogReader& log, ReplaySpeed speed, Sink&& sink);
+
+
+namespace detail
+{
+
+inline constexpr char EVENT_LOG_MAGIC[8] = {'V', 'T', 'E', 'V', 'L', 'O', 'G', 1};
+
+
+template <typename Variant>
+struct EventLogPayload;
+
+
+template <typename... Ts>
+struct EventLogPayload<compact_variant<Ts...>>
+{
+  static constexpr std::size_t sizes[] = {sizeof(Ts)...};
+
+  static compact_variant<Ts...> decode(
+    const std::size_t tag,
+    const unsigned char* pPayload)
+  {
+    using Decoder = compact_variant<Ts...> (*)(const unsigned char*);
+    constexpr Decoder decoders[] = {&decodeAs<Ts>...};
+
+    return decoders[tag](pPayload);
+  }
+
+  template <typename T>
+  static compact_variant<Ts...> decodeAs(const unsigned char* pPayload)
+  {
+    UninitializedSlot<T> slot;
+    std::memcpy(&slot.mValue, pPayload, sizeof(T));
+    return slot.mValue;
+  }
+};
+
+} // namespace detail
+
+
+inline EventLogReader::Iterator::Iterator(
+  const unsigned char* pNext,
+  const unsigned char* pEnd
+)
+  : mpCurrent(pNext)
+  , mpNext(pNext)
+  , mpEnd(pEnd)
+{
+  decodeNext();
+}
+
+
+inline void EventLogReader::Iterator::decodeNext()
+{
+  using Payload = detail::EventLogPayload<Event>;
+
+  mpCurrent = mpNext;
+
+  auto pRead = mpNext;
+  auto delta = std::uint64_t{0};
+  auto shift = 0u;
+
+  while (pRead != mpEnd && shift < 64)
+  {
+    const auto byte = *pRead++;
+    delta |= std::uint64_t{byte & 0x7Fu} << shift;
+    shift += 7;
+
+    if (!(byte & 0x80u))
+    {
+      if (pRead == mpEnd)
+      {
+        break;
+      }
+
+      const auto tag = std::size_t{*pRead++};
+      if (
+        tag >= Event::alternative_count ||
+        static_cast<std::size_t>(mpEnd - pRead) < Payload::sizes[tag])
+      {
+        break;
+      }
+
+      mRecord.mTimestamp += std::chrono::nanoseconds{delta};
+      mRecord.mEvent = Payload::decode(tag, pRead);
+      mpNext = pRead + Payload::sizes[tag];
+      return;
+    }
+  }
+
+  // End of file, or truncated/corrupt record
+  mpCurrent = mpNext = mpEnd;
+}
+
+
+template <typename Sink>
+void replay(const EventLogReader& log, const ReplaySpeed speed, Sink&& sink)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (const auto& record : log)
+  {
+    if (speed == ReplaySpeed::Original)
+    {
+      std::this_thread::sleep_until(start + record.mTimestamp);
+    }
+
+    sink(record.mEvent);
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,201 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_metrics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+constexpr const char* EVENT_TYPE_NAMES[] = {
+  "MouseMoved",
+  "MouseButtonDown",
+  "MouseButtonUp",
+  "WindowResized"
+};
+
+static_assert(
+  std::size(EVENT_TYPE_NAMES) == Event::alternative_count,
+  "Names must match Event's alternatives");
+
+constexpr double REPORTED_PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+constexpr const char* PERCENTILE_NAMES[] = {"p50", "p90", "p99", "p99.9"};
+
+
+double toMicroseconds(const std::uint64_t nanoseconds)
+{
+  return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+} // namespace
+
+
+EventMetrics::EventMetrics()
+  : mStartTime(EventClock::now())
+  , mPreviousReportTime(mStartTime)
+{
+}
+
+
+void EventMetrics::recordHandled(
+  const TimestampedEvent& event,
+  const EventClock::time_point handledAt)
+{
+  const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    handledAt - event.mReceivedAt);
+
+  mLatencies[event.mEvent.index()].record(
+    static_cast<std::uint64_t>(std::max(latency.count(), std::int64_t{0})));
+}
+
+
+void EventMetrics::recordShed(const TimestampedEvent& event)
+{
+  mNumShed[event.mEvent.index()].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto EventMetrics::takeReport(double& secondsSinceStart) -> Report
+{
+  using Seconds = std::chrono::duration<double>;
+
+  const auto now = EventClock::now();
+  const auto interval = Seconds{now - mPreviousReportTime}.count();
+  secondsSinceStart = Seconds{now - mStartTime}.count();
+  mPreviousReportTime = now;
+
+  Report report;
+  auto& total = report.back();
+  total = {"all", {}, 0.0, 0};
+
+  for (auto i = std::size_t{0}; i < Event::alternative_count; ++i)
+  {
+    auto latencies = mLatencies[i].snapshot();
+    const auto numNewEvents = latencies.count() - mPreviousCounts[i];
+    mPreviousCounts[i] = latencies.count();
+
+    const auto eventsPerSecond = interval > 0.0
+      ? static_cast<double>(numNewEvents) / interval
+      : 0.0;
+
+    const auto numShed = mNumShed[i].load(std::memory_order_relaxed);
+
+    total.mLatencies.merge(latencies);
+    total.mEventsPerSecond += eventsPerSecond;
+    total.mNumShed += numShed;
+
+    report[i] = {
+      EVENT_TYPE_NAMES[i], std::move(latencies), eventsPerSecond, numShed};
+  }
+
+  return report;
+}
+
+
+void EventMetrics::writeText(std::ostream& stream)
+{
+  auto uptime = 0.0;
+  const auto report = takeReport(uptime);
+
+  // Formatted separately, so that the stream's flags and precision stay as
+  // they were
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(1)
+    << "event latency (us) after " << uptime << " s\n"
+    << std::left << std::setw(16) << "type" << std::right
+    << std::setw(10) << "count" << std::setw(10) << "rate/s"
+    << std::setw(10) << "shed";
+
+  for (const auto pName : PERCENTILE_NAMES)
+  {
+    text << std::setw(10) << pName;
+  }
+
+  text << std::setw(10) << "max" << '\n';
+
+  for (const auto& type : report)
+  {
+    text << std::left << std::setw(16) << type.mpName << std::right
+      << std::setw(10) << type.mLatencies.count()
+      << std::setw(10) << type.mEventsPerSecond
+      << std::setw(10) << type.mNumShed;
+
+    for (const auto percent : REPORTED_PERCENTILES)
+    {
+      text << std::setw(10)
+        << toMicroseconds(type.mLatencies.percentile(percent));
+    }
+
+    text << std::setw(10) << toMicroseconds(type.mLatencies.max()) << '\n';
+  }
+
+  stream << text.str() << std::flush;
+}
+
+
+void EventMetrics::writeJson(std::ostream& stream)
+{
+  auto uptime = 0.0;
+  const auto report = takeReport(uptime);
+
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(3)
+    << "{\"uptime_s\":" << uptime << ",\"types\":{";
+
+  auto isFirst = true;
+  for (const auto& type : report)
+  {
+    if (!isFirst)
+    {
+      text << ',';
+    }
+    isFirst = false;
+
+    text << '"' << type.mpName << "\":{"
+      << "\"count\":" << type.mLatencies.count()
+      << ",\"rate_per_s\":" << type.mEventsPerSecond
+      << ",\"shed\":" << type.mNumShed
+      << ",\"latency_ns\":{";
+
+    for (auto i = std::size_t{0}; i < std::size(REPORTED_PERCENTILES); ++i)
+    {
+      text << '"' << PERCENTILE_NAMES[i] << "\":"
+        << type.mLatencies.percentile(REPORTED_PERCENTILES[i]) << ',';
+    }
+
+    text << "\"mean\":" << type.mLatencies.mean()
+      << ",\"max\":" << type.mLatencies.max() << "}}";
+  }
+
+  text << "}}\n";
+  stream << text.str() << std::flush;
+}
+
+} // namespace variant_talk
@@ -0,0 +1,80 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+#include "latency_histogram.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+
+namespace variant_talk
+{
+
+// Per event type latency histograms and counters for the event pipeline.
+//
+// Latency is measured from the time an event was received from the platform
+// until the handler has finished processing it. Events which were dropped
+// due to overload (see LoadShedder) are only counted. Recording is lock-free and
+// can happen on any thread, writing reports should only be done by one thread
+// at a time.
+class EventMetrics
+{
+public:
+  EventMetrics();
+
+  void recordHandled(
+    const TimestampedEvent& event,
+    EventClock::time_point handledAt);
+  void recordShed(const TimestampedEvent& event);
+
+  // Event rates in the reports are averaged over the time since the previous
+  // report (or since construction, for the first one).
+  void writeText(std::ostream& stream);
+  void writeJson(std::ostream& stream);
+
+private:
+  struct TypeReport
+  {
+    const char* mpName;
+    LatencyHistogram::Snapshot mLatencies;
+    double mEventsPerSecond;
+    std::uint64_t mNumShed;
+  };
+
+  using Report = std::array<TypeReport, Event::alternative_count + 1>;
+
+  Report takeReport(double& secondsSinceStart);
+
+  std::array<LatencyHistogram, Event::alternative_count> mLatencies;
+  std::array<std::atomic<std::uint64_t>, Event::alternative_count> mNumShed{};
+
+  const EventClock::time_point mStartTime;
+  EventClock::time_point mPreviousReportTime;
+  std::array<std::uint64_t, Event::alternative_count> mPreviousCounts{};
+};
+
+} // namespace variant_talk
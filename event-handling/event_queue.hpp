@@ -0,0 +1,266 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "back_off.hpp"
+#include "wakeup_signal.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+namespace variant_talk
+{
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+
+// Bounded lock-free queue for multiple producer threads and a single consumer
+// thread.
+//
+// Based on Dmitry Vyukov's bounded MPMC queue: Each cell carries a sequence
+// number, which tells producers and the consumer whether the cell is free to
+// write to, or ready to be read. Producers only contend on the enqueue
+// position, and the consumer never writes to it.
+//
+// T must be default constructible and copy assignable.
+template <typename T>
+class BoundedMpscQueue
+{
+public:
+  // The capacity is rounded up to the next power of two.
+  explicit BoundedMpscQueue(std::size_t minCapacity);
+
+  BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+  BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+  // Producer side, can be called from any number of threads
+
+  // Returns false if the queue is full.
+  bool tryPush(const T& value);
+
+  // Waits until there is room in the queue if it's full.
+  void push(const T& value, BackOffStrategy strategy);
+
+  // Consumer side, must only be called from one thread at a time
+
+  // Invokes consume(value) for up to maxCount values, in the order they were
+  // pushed, and returns how many were consumed.
+  template <typename Consumer>
+  std::size_t popBatch(Consumer&& consume, std::size_t maxCount);
+
+  // Waits until the queue is not empty, or cancel is set. Whoever sets cancel
+  // must call wakeConsumer() afterwards.
+  void waitForData(BackOffStrategy strategy, const std::atomic<bool>& cancel);
+  void wakeConsumer();
+
+  bool empty() const;
+
+  // Only approximate while other threads are modifying the queue
+  std::size_t size() const;
+  std::size_t capacity() const;
+
+private:
+  struct Cell
+  {
+    std::atomic<std::size_t> mSequence;
+    T mValue;
+  };
+
+  std::unique_ptr<Cell[]> mpCells;
+  const std::size_t mMask;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mEnqueuePos{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mDequeuePos{0};
+
+  WakeupSignal mNotEmpty;
+  WakeupSignal mNotFull;
+};
+
+
+namespace detail
+{
+
+inline std::size_t nextPowerOfTwo(const std::size_t value)
+{
+  auto result = std::size_t{1};
+  while (result < value)
+  {
+    result *= 2;
+  }
+
+  return result;
+}
+
+} // namespace detail
+
+
+template <typename T>
+BoundedMpscQueue<T>::BoundedMpscQueue(const std::size_t minCapacity)
+  : mpCells(new Cell[detail::nextPowerOfTwo(minCapacity)])
+  , mMask(detail::nextPowerOfTwo(minCapacity) - 1)
+{
+  for (auto i = std::size_t{0}; i <= mMask; ++i)
+  {
+    mpCells[i].mSequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+
+template <typename T>
+bool BoundedMpscQueue<T>::tryPush(const T& value)
+{
+  auto pos = mEnqueuePos.load(std::memory_order_relaxed);
+  Cell* pCell = nullptr;
+
+  for (;;)
+  {
+    pCell = &mpCells[pos & mMask];
+    const auto sequence = pCell->mSequence.load(std::memory_order_acquire);
+    const auto difference =
+      static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+    if (difference == 0)
+    {
+      // The cell is free, try to claim it
+      if (mEnqueuePos.compare_exchange_weak(
+        pos, pos + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (difference < 0)
+    {
+      // The consumer hasn't freed this cell yet, i.e. the queue is full
+      return false;
+    }
+    else
+    {
+      // Another producer claimed the cell
+      pos = mEnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  pCell->mValue = value;
+  pCell->mSequence.store(pos + 1, std::memory_order_release);
+
+  mNotEmpty.notifyAll();
+  return true;
+}
+
+
+template <typename T>
+void BoundedMpscQueue<T>::push(const T& value, const BackOffStrategy strategy)
+{
+  waitUntil([&]() { return tryPush(value); }, strategy, mNotFull);
+}
+
+
+template <typename T>
+template <typename Consumer>
+std::size_t BoundedMpscQueue<T>::popBatch(
+  Consumer&& consume,
+  const std::size_t maxCount)
+{
+  auto pos = mDequeuePos.load(std::memory_order_relaxed);
+  auto count = std::size_t{0};
+
+  while (count < maxCount)
+  {
+    auto& cell = mpCells[pos & mMask];
+    const auto sequence = cell.mSequence.load(std::memory_order_acquire);
+    if (sequence != pos + 1)
+    {
+      // Empty, or the producer owning this cell hasn't finished writing yet
+      break;
+    }
+
+    const T value = cell.mValue;
+    cell.mSequence.store(pos + mMask + 1, std::memory_order_release);
+    ++pos;
+    ++count;
+
+    mDequeuePos.store(pos, std::memory_order_relaxed);
+    consume(value);
+  }
+
+  if (count > 0)
+  {
+    mNotFull.notifyAll();
+  }
+
+  return count;
+}
+
+
+template <typename T>
+void BoundedMpscQueue<T>::waitForData(
+  const BackOffStrategy strategy,
+  const std::atomic<bool>& cancel)
+{
+  waitUntil(
+    [&]()
+    {
+      return !empty() || cancel.load(std::memory_order_acquire);
+    },
+    strategy,
+    mNotEmpty);
+}
+
+
+template <typename T>
+void BoundedMpscQueue<T>::wakeConsumer()
+{
+  mNotEmpty.notifyAll();
+}
+
+
+template <typename T>
+bool BoundedMpscQueue<T>::empty() const
+{
+  const auto pos = mDequeuePos.load(std::memory_order_relaxed);
+  const auto sequence =
+    mpCells[pos & mMask].mSequence.load(std::memory_order_acquire);
+
+  return sequence != pos + 1;
+}
+
+
+template <typename T>
+std::size_t BoundedMpscQueue<T>::size() const
+{
+  const auto dequeuePos = mDequeuePos.load(std::memory_order_relaxed);
+  const auto enqueuePos = mEnqueuePos.load(std::memory_order_relaxed);
+
+  return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
+
+
+template <typename T>
+std::size_t BoundedMpscQueue<T>::capacity() const
+{
+  return mMask + 1;
+}
+
+} // namespace variant_talk
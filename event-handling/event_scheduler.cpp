@@ -0,0 +1,152 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "event_scheduler.hpp"
+
+#include <algorithm>
+
+
+namespace variant_talk
+{
+
+EventScheduler::~EventScheduler()
+{
+  for (const auto handle : mTasks)
+  {
+    handle.destroy();
+  }
+}
+
+
+void EventScheduler::spawn(EventTask task)
+{
+  const auto handle = std::exchange(task.mHandle, nullptr);
+  handle.promise().mpScheduler = this;
+  handle.promise().mSpawnOrder = mNextSpawnOrder++;
+  mTasks.push_back(handle);
+
+  resume(handle);
+}
+
+
+void EventScheduler::onEvent(const Event& event)
+{
+  const auto index = event.index();
+
+  // Coroutines which start waiting again while being resumed add themselves
+  // to the (now empty) wait list, and are resumed by the next event.
+  mResumeList.clear();
+  std::swap(mResumeList, mWaitLists[index]);
+
+  for (auto i = std::size_t{0}; i < mResumeList.size(); ++i)
+  {
+    const auto pWaiter = mResumeList[i];
+    pWaiter->mEvent = event;
+    removeWaiter(*pWaiter, index);
+
+    try
+    {
+      resume(pWaiter->mHandle);
+    }
+    catch (...)
+    {
+      // Put back the ones not resumed yet, otherwise they'd never be again
+      for (auto j = i + 1; j < mResumeList.size(); ++j)
+      {
+        insertWaiter(*mResumeList[j], index);
+      }
+
+      throw;
+    }
+  }
+}
+
+
+void EventScheduler::addWaiter(detail::EventWaiter& waiter)
+{
+  for (auto i = std::size_t{0}; i < Event::alternative_count; ++i)
+  {
+    if (waiter.mAlternatives & (std::uint64_t{1} << i))
+    {
+      insertWaiter(waiter, i);
+    }
+  }
+}
+
+
+void EventScheduler::insertWaiter(
+  detail::EventWaiter& waiter,
+  const std::size_t index)
+{
+  const auto spawnOrder = waiter.mHandle.promise().mSpawnOrder;
+  const auto isSpawnedBefore =
+    [](const std::uint64_t order, const detail::EventWaiter* pOther)
+    {
+      return order < pOther->mHandle.promise().mSpawnOrder;
+    };
+
+  // Keep the list sorted by spawn order, so that the order in which
+  // coroutines are resumed doesn't depend on which events they saw before.
+  // Usually appends, as the list is refilled in order.
+  auto& waitList = mWaitLists[index];
+  waitList.insert(
+    std::upper_bound(
+      waitList.begin(), waitList.end(), spawnOrder, isSpawnedBefore),
+    &waiter);
+}
+
+
+void EventScheduler::removeWaiter(
+  detail::EventWaiter& waiter,
+  const std::size_t exceptFromIndex)
+{
+  // Only needed for coroutines waiting on more than one alternative
+  for (auto i = std::size_t{0}; i < Event::alternative_count; ++i)
+  {
+    const auto isWaitingFor = waiter.mAlternatives & (std::uint64_t{1} << i);
+    if (i != exceptFromIndex && isWaitingFor)
+    {
+      auto& waitList = mWaitLists[i];
+      waitList.erase(std::find(waitList.begin(), waitList.end(), &waiter));
+    }
+  }
+}
+
+
+void EventScheduler::resume(const EventTask::Handle handle)
+{
+  handle.resume();
+
+  if (handle.done())
+  {
+    const auto exception = handle.promise().mException;
+
+    mTasks.erase(std::find(mTasks.begin(), mTasks.end(), handle));
+    handle.destroy();
+
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,257 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "coroutine_frame_pool.hpp"
+#include "event.hpp"
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+class EventScheduler;
+
+
+// Return type for event handling coroutines. Such a coroutine does nothing
+// until it's handed to EventScheduler::spawn(), which then owns it.
+//
+// Frames are allocated from the calling thread's CoroutineFramePool.
+class EventTask
+{
+public:
+  struct promise_type
+  {
+    EventTask get_return_object()
+    {
+      return EventTask{Handle::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void return_void()
+    {
+    }
+
+    void unhandled_exception()
+    {
+      mException = std::current_exception();
+    }
+
+    static void* operator new(const std::size_t size)
+    {
+      return CoroutineFramePool::forThisThread().allocate(size);
+    }
+
+    static void operator delete(void* pFrame, const std::size_t size)
+    {
+      CoroutineFramePool::forThisThread().deallocate(pFrame, size);
+    }
+
+    EventScheduler* mpScheduler = nullptr;
+    std::uint64_t mSpawnOrder = 0;
+    std::exception_ptr mException;
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  EventTask(EventTask&& other) noexcept
+    : mHandle(std::exchange(other.mHandle, nullptr))
+  {
+  }
+
+  EventTask& operator=(EventTask&& other) noexcept
+  {
+    if (this != &other)
+    {
+      destroy();
+      mHandle = std::exchange(other.mHandle, nullptr);
+    }
+
+    return *this;
+  }
+
+  ~EventTask()
+  {
+    destroy();
+  }
+
+private:
+  friend class EventScheduler;
+
+  explicit EventTask(const Handle handle)
+    : mHandle(handle)
+  {
+  }
+
+  void destroy()
+  {
+    if (mHandle)
+    {
+      mHandle.destroy();
+      mHandle = nullptr;
+    }
+  }
+
+  Handle mHandle;
+};
+
+
+namespace detail
+{
+
+// A coroutine suspended in co_await nextEvent<...>(), waiting for any of the
+// alternatives in mAlternatives
+struct EventWaiter
+{
+  EventTask::Handle mHandle;
+  std::uint64_t mAlternatives = 0;
+  Event mEvent;
+};
+
+
+template <typename... Ts>
+constexpr std::uint64_t alternativeMask()
+{
+  static_assert(
+    Event::alternative_count <= 64, "Too many alternatives for the mask");
+  return ((std::uint64_t{1} << Event::index_of<Ts>) | ...);
+}
+
+} // namespace detail
+
+
+// Resumes event handling coroutines when the events they are waiting for
+// arrive.
+//
+// Each alternative of Event has its own list of waiting coroutines. Handling
+// an event only resumes the coroutines in the list for its type, in the order
+// they were spawned, so a coroutine which waits for a button press costs
+// nothing while the mouse is moving.
+//
+// A coroutine which awaits the next event again while being resumed waits for
+// the next one, it won't see the current event a second time. The scheduler
+// destroys coroutines once they finish. Exceptions escaping a coroutine are
+// rethrown from onEvent(). Coroutines which would have been resumed after the
+// failing one keep waiting, without seeing the event.
+//
+// Not thread safe, spawn() and onEvent() must be called on the same thread.
+class EventScheduler
+{
+public:
+  EventScheduler() = default;
+  ~EventScheduler();
+
+  EventScheduler(const EventScheduler&) = delete;
+  EventScheduler& operator=(const EventScheduler&) = delete;
+
+  // Runs the coroutine until it waits for its first event.
+  void spawn(EventTask task);
+
+  void onEvent(const Event& event);
+
+  std::size_t numWaiting(std::size_t alternativeIndex) const
+  {
+    return mWaitLists[alternativeIndex].size();
+  }
+
+private:
+  template <typename... Ts>
+  friend class EventAwaiter;
+
+  void addWaiter(detail::EventWaiter& waiter);
+  void insertWaiter(detail::EventWaiter& waiter, std::size_t index);
+  void removeWaiter(detail::EventWaiter& waiter, std::size_t exceptFromIndex);
+  void resume(EventTask::Handle handle);
+
+  std::array<std::vector<detail::EventWaiter*>, Event::alternative_count>
+    mWaitLists;
+  std::vector<detail::EventWaiter*> mResumeList;
+  std::vector<EventTask::Handle> mTasks;
+  std::uint64_t mNextSpawnOrder = 0;
+};
+
+
+// Awaitable returned by nextEvent(). Resumes with the alternative's value if
+// waiting for a single alternative, or with the Event otherwise.
+template <typename... Ts>
+class EventAwaiter
+{
+public:
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void await_suspend(const EventTask::Handle handle)
+  {
+    mWaiter.mHandle = handle;
+    mWaiter.mAlternatives = detail::alternativeMask<Ts...>();
+    handle.promise().mpScheduler->addWaiter(mWaiter);
+  }
+
+  auto await_resume() const
+  {
+    if constexpr (sizeof...(Ts) == 1)
+    {
+      return mWaiter.mEvent.template get<Ts...>();
+    }
+    else
+    {
+      return mWaiter.mEvent;
+    }
+  }
+
+private:
+  detail::EventWaiter mWaiter;
+};
+
+
+// Suspends the calling coroutine until an event of one of the given types
+// arrives. Can only be awaited in an EventTask coroutine.
+template <typename... Ts>
+EventAwaiter<Ts...> nextEvent()
+{
+  static_assert(sizeof...(Ts) > 0, "Need at least one event type");
+  static_assert(
+    ((Event::index_of<Ts> < Event::alternative_count) && ...),
+    "Not an event type");
+
+  return {};
+}
+
+} // namespace variant_talk
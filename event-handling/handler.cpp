@@ -23,7 +23,7 @@
 
 #include "match.hpp"
 
-#include <iostream>
+#include <ostream>
 
 
 namespace variant_talk
@@ -56,6 +56,46 @@ std::ostream& operator<<(std::ostream& os, const MouseButton button)
   return os;
 }
 
+
+// Log formats. These run on the logging thread in case of an asynchronous
+// log sink, so the handler doesn't pay for the formatting.
+
+void formatMouseMoved(std::ostream& out, const LogArguments& args)
+{
+  out << "mouse moved to " << args[0] << ", " << args[1] << "\n";
+}
+
+
+void formatMouseButtonDown(std::ostream& out, const LogArguments& args)
+{
+  out << "mouse button down (" << static_cast<MouseButton>(args[0]) << ")\n";
+}
+
+
+void formatMouseButtonUp(std::ostream& out, const LogArguments& args)
+{
+  out << "mouse button up (" << static_cast<MouseButton>(args[0]) << ")\n";
+}
+
+
+void formatPrintMouseMovesToggled(std::ostream& out, const LogArguments& args)
+{
+  out << "\nprinting mouse moves: " << std::boolalpha <<
+    static_cast<bool>(args[0]) << "\n\n";
+}
+
+
+void formatWindowResized(std::ostream& out, const LogArguments& args)
+{
+  out << "window resized to " << args[0] << ", " << args[1] << "\n";
+}
+
+} // namespace
+
+
+ExampleEventHandler::ExampleEventHandler(LogSink& log)
+  : mpLog(&log)
+{
 }
 
 
@@ -63,38 +103,118 @@ void ExampleEventHandler::onEvent(const Event& event)
 {
   using namespace event;
 
-  match(event,
-    [this](const MouseMoved& mouseMove)
+  auto& log = *mpLog;
+
+  match_likely<MouseMoved>(event,
+    [&](const MouseMoved& mouseMove)
     {
       if (mShouldPrintMouseMoves)
       {
-        std::cout << "mouse moved to " <<
-          mouseMove.x << ", " << mouseMove.y << "\n";
+        log.log(formatMouseMoved, mouseMove.x, mouseMove.y);
       }
     },
 
-    [this](const MouseButtonDown& buttonDown)
+    [&](const MouseButtonDown& buttonDown)
     {
-      std::cout << "mouse button down (" << buttonDown.button << ")\n";
+      log.log(formatMouseButtonDown, buttonDown.button);
 
       if (buttonDown.button == MouseButton::Right)
       {
         mShouldPrintMouseMoves = !mShouldPrintMouseMoves;
-        std::cout << "\nprinting mouse moves: " << std::boolalpha <<
-          mShouldPrintMouseMoves << "\n\n";
+        log.log(formatPrintMouseMovesToggled, mShouldPrintMouseMoves);
       }
     },
 
-    [](const MouseButtonUp& buttonUp)
+    [&](const MouseButtonUp& buttonUp)
     {
-      std::cout << "mouse button up (" << buttonUp.button << ")\n";
+      log.log(formatMouseButtonUp, buttonUp.button);
     },
 
-    [](const WindowResized& resized)
+    [&](const WindowResized& resized)
     {
-      std::cout << "window resized to " <<
-        resized.newWidth << ", " << resized.newHeight << "\n";
+      log.log(formatWindowResized, resized.newWidth, resized.newHeight);
     });
 }
 
+
+#if defined(VARIANT_TALK_COROUTINES)
+
+CoroutineEventHandler::CoroutineEventHandler(LogSink& log)
+  : mpLog(&log)
+{
+  // Buttons first, so that a right click logs the button before the toggle
+  mScheduler.spawn(logMouseButtons());
+  mScheduler.spawn(logMouseMoves());
+  mScheduler.spawn(logWindowResizes());
+}
+
+
+EventTask CoroutineEventHandler::logMouseButtons()
+{
+  using namespace event;
+
+  for (;;)
+  {
+    const auto event = co_await nextEvent<MouseButtonDown, MouseButtonUp>();
+
+    match(event,
+      [&](const MouseButtonDown& buttonDown)
+      {
+        mpLog->log(formatMouseButtonDown, buttonDown.button);
+      },
+
+      [&](const MouseButtonUp& buttonUp)
+      {
+        mpLog->log(formatMouseButtonUp, buttonUp.button);
+      },
+
+      [](const auto&) {});
+  }
+}
+
+
+EventTask CoroutineEventHandler::logMouseMoves()
+{
+  using namespace event;
+
+  auto shouldPrintMouseMoves = true;
+
+  for (;;)
+  {
+    // While not printing, mouse moves don't resume this coroutine at all
+    const auto event = shouldPrintMouseMoves
+      ? co_await nextEvent<MouseMoved, MouseButtonDown>()
+      : Event{co_await nextEvent<MouseButtonDown>()};
+
+    match(event,
+      [&](const MouseMoved& mouseMove)
+      {
+        mpLog->log(formatMouseMoved, mouseMove.x, mouseMove.y);
+      },
+
+      [&](const MouseButtonDown& buttonDown)
+      {
+        if (buttonDown.button == MouseButton::Right)
+        {
+          shouldPrintMouseMoves = !shouldPrintMouseMoves;
+          mpLog->log(formatPrintMouseMovesToggled, shouldPrintMouseMoves);
+        }
+      },
+
+      [](const auto&) {});
+  }
+}
+
+
+EventTask CoroutineEventHandler::logWindowResizes()
+{
+  for (;;)
+  {
+    const auto resized = co_await nextEvent<event::WindowResized>();
+    mpLog->log(formatWindowResized, resized.newWidth, resized.newHeight);
+  }
+}
+
+#endif
+
 } // namespace variant_talk
@@ -22,6 +22,11 @@
 #pragma once
 
 #include "event.hpp"
+#include "log_sink.hpp"
+
+#if defined(VARIANT_TALK_COROUTINES)
+#include "event_scheduler.hpp"
+#endif
 
 
 namespace variant_talk
@@ -30,10 +35,42 @@ namespace variant_talk
 class ExampleEventHandler
 {
 public:
+  explicit ExampleEventHandler(LogSink& log);
+
   void onEvent(const Event& event);
 
 private:
+  LogSink* mpLog;
   bool mShouldPrintMouseMoves = true;
 };
 
+
+#if defined(VARIANT_TALK_COROUTINES)
+
+// Same behavior as ExampleEventHandler, written as coroutines which each wait
+// only for the events they care about.
+class CoroutineEventHandler
+{
+public:
+  explicit CoroutineEventHandler(LogSink& log);
+
+  CoroutineEventHandler(const CoroutineEventHandler&) = delete;
+  CoroutineEventHandler& operator=(const CoroutineEventHandler&) = delete;
+
+  void onEvent(const Event& event)
+  {
+    mScheduler.onEvent(event);
+  }
+
+private:
+  EventTask logMouseButtons();
+  EventTask logMouseMoves();
+  EventTask logWindowResizes();
+
+  LogSink* mpLog;
+  EventScheduler mScheduler;
+};
+
+#endif
+
 } // namespace variant_talk
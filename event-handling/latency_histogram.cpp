@@ -0,0 +1,170 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+std::size_t indexOfHighestBit(const std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - static_cast<std::size_t>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return index;
+#else
+  auto index = std::size_t{0};
+  for (auto remaining = value >> 1; remaining != 0; remaining >>= 1)
+  {
+    ++index;
+  }
+
+  return index;
+#endif
+}
+
+} // namespace
+
+
+void LatencyHistogram::record(const std::uint64_t nanoseconds)
+{
+  const auto index = bucketIndex(nanoseconds);
+  mBuckets[index].fetch_add(1, std::memory_order_relaxed);
+  mSum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+  auto max = mMax.load(std::memory_order_relaxed);
+  while (
+    nanoseconds > max &&
+    !mMax.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+  {
+  }
+}
+
+
+auto LatencyHistogram::snapshot() const -> Snapshot
+{
+  Snapshot result;
+
+  for (auto i = std::size_t{0}; i < NUM_BUCKETS; ++i)
+  {
+    result.mBuckets[i] = mBuckets[i].load(std::memory_order_relaxed);
+    result.mCount += result.mBuckets[i];
+  }
+
+  result.mSum = mSum.load(std::memory_order_relaxed);
+  result.mMax = mMax.load(std::memory_order_relaxed);
+  return result;
+}
+
+
+std::size_t LatencyHistogram::bucketIndex(const std::uint64_t value)
+{
+  if (value < SUB_BUCKET_COUNT)
+  {
+    return static_cast<std::size_t>(value);
+  }
+
+  // The highest bit selects the power of two range, the next SUB_BUCKET_BITS
+  // bits the bucket within it.
+  const auto highestBit =
+    std::min(indexOfHighestBit(value), MAX_VALUE_BITS - 1);
+  const auto shift = highestBit - SUB_BUCKET_BITS;
+  const auto subBucket = std::min<std::uint64_t>(
+    (value >> shift) - SUB_BUCKET_COUNT, SUB_BUCKET_COUNT - 1);
+
+  return (shift + 1) * SUB_BUCKET_COUNT + static_cast<std::size_t>(subBucket);
+}
+
+
+std::uint64_t LatencyHistogram::bucketUpperBound(const std::size_t index)
+{
+  if (index < SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+
+  const auto shift = index / SUB_BUCKET_COUNT - 1;
+  const auto subBucket = index % SUB_BUCKET_COUNT;
+  const auto lowerBound = (SUB_BUCKET_COUNT + subBucket) << shift;
+
+  return lowerBound + (std::uint64_t{1} << shift) - 1;
+}
+
+
+double LatencyHistogram::Snapshot::mean() const
+{
+  return mCount > 0
+    ? static_cast<double>(mSum) / static_cast<double>(mCount)
+    : 0.0;
+}
+
+
+std::uint64_t LatencyHistogram::Snapshot::percentile(const double percent) const
+{
+  if (mCount == 0)
+  {
+    return 0;
+  }
+
+  const auto rank = std::max<std::uint64_t>(
+    1,
+    static_cast<std::uint64_t>(
+      percent / 100.0 * static_cast<double>(mCount) + 0.5));
+
+  auto seen = std::uint64_t{0};
+  for (auto i = std::size_t{0}; i < NUM_BUCKETS; ++i)
+  {
+    seen += mBuckets[i];
+    if (seen >= rank)
+    {
+      return std::min(bucketUpperBound(i), mMax);
+    }
+  }
+
+  return mMax;
+}
+
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other)
+{
+  for (auto i = std::size_t{0}; i < NUM_BUCKETS; ++i)
+  {
+    mBuckets[i] += other.mBuckets[i];
+  }
+
+  mCount += other.mCount;
+  mSum += other.mSum;
+  mMax = std::max(mMax, other.mMax);
+}
+
+} // namespace variant_talk
@@ -0,0 +1,96 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace variant_talk
+{
+
+// Histogram of latency values in nanoseconds, which can be updated from any
+// number of threads without locking.
+//
+// Like an HdrHistogram, buckets are spaced log-linearly: every power of two
+// range is split into 32 equally wide buckets, so recorded values are
+// accurate to about 3%, across the entire range from nanoseconds to minutes.
+// Values below 32 ns are recorded exactly, values above about 18 minutes are
+// clamped.
+class LatencyHistogram
+{
+public:
+  static constexpr std::size_t SUB_BUCKET_BITS = 5;
+  static constexpr std::size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static constexpr std::size_t MAX_VALUE_BITS = 40;
+  static constexpr std::size_t NUM_BUCKETS =
+    (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  // Copy of the histogram's state at one point in time, for evaluation.
+  class Snapshot
+  {
+  public:
+    std::uint64_t count() const
+    {
+      return mCount;
+    }
+
+    std::uint64_t max() const
+    {
+      return mMax;
+    }
+
+    double mean() const;
+
+    // The value below which the given percentage of recorded values lie,
+    // rounded up to the upper end of its bucket
+    std::uint64_t percentile(double percent) const;
+
+    void merge(const Snapshot& other);
+
+  private:
+    friend class LatencyHistogram;
+
+    std::array<std::uint64_t, NUM_BUCKETS> mBuckets{};
+    std::uint64_t mCount = 0;
+    std::uint64_t mSum = 0;
+    std::uint64_t mMax = 0;
+  };
+
+  void record(std::uint64_t nanoseconds);
+
+  // Buckets are read one by one, so values recorded concurrently might be
+  // partially included.
+  Snapshot snapshot() const;
+
+  static std::size_t bucketIndex(std::uint64_t value);
+  static std::uint64_t bucketUpperBound(std::size_t index);
+
+private:
+  std::array<std::atomic<std::uint64_t>, NUM_BUCKETS> mBuckets{};
+  std::atomic<std::uint64_t> mSum{0};
+  std::atomic<std::uint64_t> mMax{0};
+};
+
+} // namespace variant_talk
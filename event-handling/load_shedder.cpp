@@ -0,0 +1,79 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "load_shedder.hpp"
+
+#include "match.hpp"
+
+
+namespace variant_talk
+{
+
+EventPriority priorityOf(const Event& event)
+{
+  using namespace event;
+
+  return match_likely<MouseMoved>(event,
+    [](const MouseMoved&) { return EventPriority::Sampled; },
+    [](const MouseButtonDown&) { return EventPriority::Critical; },
+    [](const MouseButtonUp&) { return EventPriority::Critical; },
+    [](const WindowResized&) { return EventPriority::LatestWins; });
+}
+
+
+LoadShedder::LoadShedder(const OverloadPolicy& policy)
+  : mPolicy(policy)
+{
+}
+
+
+bool LoadShedder::isOverloaded(
+  const TimestampedEvent& event,
+  const std::size_t queueDepth) const
+{
+  if (!mPolicy.mIsEnabled)
+  {
+    return false;
+  }
+
+  return
+    queueDepth > mPolicy.mMaxQueueDepth ||
+    EventClock::now() - event.mReceivedAt > mPolicy.mMaxAge;
+}
+
+
+bool LoadShedder::takeSample()
+{
+  if (mPolicy.mSamplingInterval == 0)
+  {
+    return false;
+  }
+
+  if (++mNumSkippedSinceSample < mPolicy.mSamplingInterval)
+  {
+    return false;
+  }
+
+  mNumSkippedSinceSample = 0;
+  return true;
+}
+
+} // namespace variant_talk
@@ -0,0 +1,167 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+
+namespace variant_talk
+{
+
+// How the event pipeline treats an event type when it's overloaded
+enum class EventPriority
+{
+  // Always handled (button presses and releases)
+  Critical,
+
+  // Only the most recent one is handled (resizes)
+  LatestWins,
+
+  // Only every n-th one is handled, or none at all (mouse moves)
+  Sampled
+};
+
+
+EventPriority priorityOf(const Event& event);
+
+
+struct OverloadPolicy
+{
+  // The pipeline counts as overloaded while more events than this are waiting
+  // in the queue, or while events are older than mMaxAge by the time they are
+  // taken out of the queue.
+  std::size_t mMaxQueueDepth = 1024;
+  std::chrono::microseconds mMaxAge = std::chrono::milliseconds{50};
+
+  // While overloaded, every n-th Sampled event is handled. 0 drops all of
+  // them.
+  std::uint32_t mSamplingInterval = 8;
+
+  bool mIsEnabled = true;
+};
+
+
+// Pipeline stage on the consumer side of the event queue, which sheds events
+// according to an OverloadPolicy.
+//
+// Events are passed on to a sink, or to a shed sink if they are dropped. Both
+// are callables accepting a const TimestampedEvent&. While not overloaded,
+// all events go straight to the sink.
+//
+// A LatestWins event arriving while overloaded is held back, and replaced
+// (i.e., shed) if another one of the same type follows. It is passed on
+// before the next Critical event, or when flush() is called, which should
+// happen after each batch taken out of the queue.
+class LoadShedder
+{
+public:
+  explicit LoadShedder(const OverloadPolicy& policy);
+
+  template <typename Sink, typename ShedSink>
+  void push(
+    const TimestampedEvent& event,
+    std::size_t queueDepth,
+    Sink&& sink,
+    ShedSink&& shed);
+
+  template <typename Sink>
+  void flush(Sink&& sink);
+
+private:
+  bool isOverloaded(
+    const TimestampedEvent& event,
+    std::size_t queueDepth) const;
+  bool takeSample();
+
+  OverloadPolicy mPolicy;
+  std::optional<TimestampedEvent> mPendingLatest;
+  std::uint32_t mNumSkippedSinceSample = 0;
+};
+
+
+template <typename Sink, typename ShedSink>
+void LoadShedder::push(
+  const TimestampedEvent& event,
+  const std::size_t queueDepth,
+  Sink&& sink,
+  ShedSink&& shed)
+{
+  if (!isOverloaded(event, queueDepth))
+  {
+    flush(sink);
+    sink(event);
+    return;
+  }
+
+  switch (priorityOf(event.mEvent))
+  {
+    case EventPriority::Critical:
+      flush(sink);
+      sink(event);
+      break;
+
+    case EventPriority::LatestWins:
+      if (mPendingLatest)
+      {
+        if (mPendingLatest->mEvent.index() == event.mEvent.index())
+        {
+          shed(*mPendingLatest);
+        }
+        else
+        {
+          sink(*mPendingLatest);
+        }
+      }
+
+      mPendingLatest = event;
+      break;
+
+    case EventPriority::Sampled:
+      if (takeSample())
+      {
+        sink(event);
+      }
+      else
+      {
+        shed(event);
+      }
+      break;
+  }
+}
+
+
+template <typename Sink>
+void LoadShedder::flush(Sink&& sink)
+{
+  if (mPendingLatest)
+  {
+    sink(*mPendingLatest);
+    mPendingLatest.reset();
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,85 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace variant_talk
+{
+
+constexpr std::size_t MAX_LOG_ARGUMENTS = 3;
+
+using LogArguments = std::array<std::int64_t, MAX_LOG_ARGUMENTS>;
+
+// Turns a log record's arguments into text. The address of the function also
+// serves as the record's format id, so records are cheap to create and copy,
+// and the formatting can happen later, on a different thread.
+using LogFormat = void (*)(std::ostream&, const LogArguments&);
+
+
+// Destination for log output.
+//
+// Arguments are integers (or anything convertible to one, like enums and
+// bools), which the format function has to convert back as needed.
+class LogSink
+{
+public:
+  virtual ~LogSink() = default;
+
+  template <typename... Args>
+  void log(const LogFormat format, const Args... args)
+  {
+    static_assert(
+      sizeof...(Args) <= MAX_LOG_ARGUMENTS, "Too many log arguments");
+
+    write(format, LogArguments{static_cast<std::int64_t>(args)...});
+  }
+
+protected:
+  virtual void write(LogFormat format, const LogArguments& arguments) = 0;
+};
+
+
+// Formats records immediately, on the calling thread.
+class StreamLogSink : public LogSink
+{
+public:
+  explicit StreamLogSink(std::ostream& stream)
+    : mpStream(&stream)
+  {
+  }
+
+protected:
+  void write(const LogFormat format, const LogArguments& arguments) override
+  {
+    format(*mpStream, arguments);
+  }
+
+private:
+  std::ostream* mpStream;
+};
+
+} // namespace variant_talk
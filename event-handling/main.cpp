@@ -19,11 +19,32 @@
  * SOFTWARE.
  */
 
+#include "async_logger.hpp"
+#include "event_coalescer.hpp"
+#include "event_consumer.hpp"
+#include "event_log.hpp"
+#include "event_metrics.hpp"
+#include "event_queue.hpp"
 #include "handler.hpp"
+#include "metrics_reporter.hpp"
+
+#ifdef VARIANT_TALK_HAS_SHARED_EVENT_CHANNEL
+#include "shared_event_channel.hpp"
+#endif
+
+#include "match.hpp"
 
 #include <SFML/Window.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iostream>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 
 
 using namespace variant_talk;
@@ -79,31 +100,283 @@ std::optional<Event> platformToGeneric(const sf::Event& event)
   return {};
 }
 
+
+constexpr auto QUEUE_CAPACITY = 4096u;
+constexpr auto SHARED_CHANNEL_CAPACITY = 16384u;
+
+// How long the poll pump sleeps when there are no events
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds{1};
+
+
+enum class Pump
+{
+  // Block in waitEvent() until the platform delivers an event
+  Wait,
+
+  // Check for events with pollEvent() at a fixed interval, like a game loop
+  // which renders in between
+  Poll
+};
+
+
+std::optional<BackOffStrategy> parseBackOffStrategy(std::string_view name)
+{
+  if (name == "spin")
+  {
+    return BackOffStrategy::Spin;
+  }
+  else if (name == "yield")
+  {
+    return BackOffStrategy::Yield;
+  }
+  else if (name == "block")
+  {
+    return BackOffStrategy::Block;
+  }
+
+  return {};
+}
+
+
+// Returns nothing unless all of the text is a number of at least minValue
+std::optional<long> parseInteger(std::string_view text, const long minValue)
+{
+  const auto string = std::string{text};
+
+  try
+  {
+    std::size_t length = 0;
+    const auto number = std::stol(string, &length);
+    if (length == string.size() && number >= minValue)
+    {
+      return number;
+    }
+  }
+  catch (const std::logic_error&)
+  {
+  }
+
+  return std::nullopt;
+}
+
 } // namespace
 
 
-int main()
+int main(int argc, char** argv)
 {
+  auto backOffStrategy = BackOffStrategy::Block;
+  auto coalesceEvents = true;
+  auto pump = Pump::Wait;
+  auto metricsFormat = MetricsFormat::Text;
+  auto metricsInterval = std::chrono::milliseconds{0};
+  OverloadPolicy overloadPolicy;
+  std::string recordPath;
+  std::string publishChannel;
+
+  for (auto i = 1; i < argc; ++i)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string_view{i + 1 < argc ? argv[i + 1] : ""};
+    const auto maybeStrategy = parseBackOffStrategy(value);
+
+    // A depth or age of 0 would make the load shedder drop every event
+    const auto maybePositive = parseInteger(value, 1);
+    const auto maybeNonNegative = parseInteger(value, 0);
+
+    if (arg == "--back-off" && maybeStrategy)
+    {
+      backOffStrategy = *maybeStrategy;
+      ++i;
+    }
+    else if (arg == "--no-coalescing")
+    {
+      coalesceEvents = false;
+    }
+    else if (arg == "--record" && i + 1 < argc)
+    {
+      recordPath = argv[i + 1];
+      ++i;
+    }
+    else if (arg == "--publish" && i + 1 < argc)
+    {
+      publishChannel = argv[i + 1];
+      ++i;
+    }
+    else if (arg == "--pump" && (value == "wait" || value == "poll"))
+    {
+      pump = value == "poll" ? Pump::Poll : Pump::Wait;
+      ++i;
+    }
+    else if (
+      arg == "--metrics-format" && (value == "text" || value == "json"))
+    {
+      metricsFormat =
+        value == "json" ? MetricsFormat::Json : MetricsFormat::Text;
+      ++i;
+    }
+    else if (arg == "--no-shedding")
+    {
+      overloadPolicy.mIsEnabled = false;
+    }
+    else if (arg == "--max-queue-depth" && maybePositive)
+    {
+      overloadPolicy.mMaxQueueDepth = static_cast<std::size_t>(*maybePositive);
+      ++i;
+    }
+    else if (arg == "--max-event-age" && maybePositive)
+    {
+      overloadPolicy.mMaxAge = std::chrono::milliseconds{*maybePositive};
+      ++i;
+    }
+    else if (arg == "--metrics-interval" && maybeNonNegative)
+    {
+      metricsInterval = std::chrono::milliseconds{*maybeNonNegative};
+      ++i;
+    }
+    else
+    {
+      std::cerr <<
+        "Usage: event_handling [--back-off spin|yield|block] "
+        "[--no-coalescing] [--record file]\n"
+        "                      [--pump wait|poll] "
+        "[--metrics-interval milliseconds]\n"
+        "                      [--metrics-format text|json]\n"
+        "                      [--no-shedding] [--max-queue-depth events]\n"
+        "                      [--max-event-age milliseconds]\n"
+        "                      [--publish /shared-memory-name]\n"
+        "Send SIGUSR1 to print latency metrics at any time.\n";
+      return 1;
+    }
+  }
+
+  // Records the events as they come from the platform, before coalescing, so
+  // that the trace can be replayed through different pipeline configurations
+  // (see event_handling_bench).
+  std::optional<EventLogWriter> recording;
+
+#ifdef VARIANT_TALK_HAS_SHARED_EVENT_CHANNEL
+  // Makes the (coalesced) events available to event_handling_subscriber
+  // processes
+  std::optional<SharedEventPublisher> publisher;
+#endif
+
+  try
+  {
+    if (!recordPath.empty())
+    {
+      recording.emplace(recordPath);
+    }
+
+    if (!publishChannel.empty())
+    {
+#ifdef VARIANT_TALK_HAS_SHARED_EVENT_CHANNEL
+      publisher.emplace(publishChannel, SHARED_CHANNEL_CAPACITY);
+#else
+      std::cerr << "Publishing events is not supported on this platform\n";
+      return 1;
+#endif
+    }
+  }
+  catch (const std::exception& error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+
+  const auto recordingStart = EventClock::now();
+
   sf::Window window{sf::VideoMode{500, 500}, "Event Handler example"};
 
-  ExampleEventHandler handler;
+  // Keeps terminal I/O from stalling the handler
+  AsyncLogger log{std::cout};
+  ExampleEventHandler handler{log};
+
+  // Reports go to stderr, to keep them apart from the handler's output
+  EventMetrics metrics;
+  MetricsReporter reporter{metrics, std::cerr, metricsFormat, metricsInterval};
 
-  while (window.isOpen())
+  // The handler runs on its own thread. Any number of threads can feed events
+  // into the queue, here it's just the window's event loop.
+  EventQueue queue{QUEUE_CAPACITY};
+  EventConsumer consumer{
+    queue, handler, metrics, backOffStrategy, overloadPolicy};
+
+  EventCoalescer coalescer;
+  auto enqueue = [&](const TimestampedEvent& event)
   {
-    sf::Event platformEvent;
+#ifdef VARIANT_TALK_HAS_SHARED_EVENT_CHANNEL
+    if (publisher)
+    {
+      publisher->publish(event);
+    }
+#endif
 
-    while (window.waitEvent(platformEvent))
+    queue.push(event, backOffStrategy);
+  };
+
+  auto processPlatformEvent = [&](const sf::Event& platformEvent)
+  {
+    const auto receivedAt = EventClock::now();
+
+    if (platformEvent.type == sf::Event::Closed)
     {
-      if (platformEvent.type == sf::Event::Closed)
+      window.close();
+      return;
+    }
+
+    if (const auto genericEvent = platformToGeneric(platformEvent))
+    {
+      if (recording)
       {
-        window.close();
-        break;
+        recording->append(*genericEvent, receivedAt - recordingStart);
       }
 
-      if (const auto genericEvent = platformToGeneric(platformEvent))
+      const auto timestampedEvent = TimestampedEvent{*genericEvent, receivedAt};
+      if (coalesceEvents)
       {
-        handler.onEvent(*genericEvent);
+        coalescer.push(timestampedEvent, enqueue);
+      }
+      else
+      {
+        enqueue(timestampedEvent);
       }
     }
+  };
+
+  sf::Event platformEvent;
+
+  if (pump == Pump::Wait)
+  {
+    while (window.isOpen() && window.waitEvent(platformEvent))
+    {
+      // Take everything that arrived since the last wait as one batch, so that
+      // moves and resizes within it can be coalesced.
+      do
+      {
+        processPlatformEvent(platformEvent);
+      }
+      while (window.isOpen() && window.pollEvent(platformEvent));
+
+      coalescer.flush(enqueue);
+    }
+  }
+  else
+  {
+    while (window.isOpen())
+    {
+      while (window.isOpen() && window.pollEvent(platformEvent))
+      {
+        processPlatformEvent(platformEvent);
+      }
+
+      coalescer.flush(enqueue);
+      std::this_thread::sleep_for(POLL_INTERVAL);
+    }
   }
+
+  consumer.stop();
+
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  printMatchStatistics(std::cerr);
+#endif
 }
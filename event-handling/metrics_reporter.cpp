@@ -0,0 +1,130 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "metrics_reporter.hpp"
+
+#include <atomic>
+#include <csignal>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+std::atomic<bool> gReportRequested{false};
+
+
+#ifdef SIGUSR1
+extern "C" void requestReport(int)
+{
+  gReportRequested.store(true, std::memory_order_relaxed);
+}
+#endif
+
+} // namespace
+
+
+MetricsReporter::MetricsReporter(
+  EventMetrics& metrics,
+  std::ostream& stream,
+  const MetricsFormat format,
+  const std::chrono::milliseconds interval
+)
+  : mMetrics(metrics)
+  , mStream(stream)
+  , mFormat(format)
+  , mInterval(interval)
+  , mThread([this]() { run(); })
+{
+#ifdef SIGUSR1
+  std::signal(SIGUSR1, requestReport);
+#endif
+}
+
+
+MetricsReporter::~MetricsReporter()
+{
+#ifdef SIGUSR1
+  std::signal(SIGUSR1, SIG_DFL);
+#endif
+
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    mStopRequested = true;
+  }
+
+  mStopCondition.notify_one();
+  mThread.join();
+
+  writeReport();
+}
+
+
+void MetricsReporter::writeReport()
+{
+  if (mFormat == MetricsFormat::Json)
+  {
+    mMetrics.writeJson(mStream);
+  }
+  else
+  {
+    mMetrics.writeText(mStream);
+  }
+}
+
+
+void MetricsReporter::run()
+{
+  using Clock = std::chrono::steady_clock;
+
+  auto nextReportTime = Clock::now() + mInterval;
+
+  std::unique_lock<std::mutex> lock{mMutex};
+
+  for (;;)
+  {
+    const auto stopRequested = mStopCondition.wait_for(
+      lock, SIGNAL_POLL_INTERVAL, [this]() { return mStopRequested; });
+    if (stopRequested)
+    {
+      return;
+    }
+
+    const auto now = Clock::now();
+    const auto isIntervalDue =
+      mInterval.count() > 0 && now >= nextReportTime;
+
+    if (gReportRequested.exchange(false, std::memory_order_relaxed) ||
+        isIntervalDue)
+    {
+      writeReport();
+    }
+
+    if (isIntervalDue)
+    {
+      nextReportTime = now + mInterval;
+    }
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,81 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event_metrics.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+
+namespace variant_talk
+{
+
+enum class MetricsFormat
+{
+  Text,
+  Json
+};
+
+
+// Runs a thread which writes EventMetrics reports to a stream at a fixed
+// interval, and/or whenever the process receives SIGUSR1 (on platforms which
+// have it). An interval of zero disables the periodic reports.
+//
+// A final report is written when the reporter is destroyed. Only one reporter
+// should exist at a time, since the signal handler is process wide.
+class MetricsReporter
+{
+public:
+  MetricsReporter(
+    EventMetrics& metrics,
+    std::ostream& stream,
+    MetricsFormat format,
+    std::chrono::milliseconds interval);
+  ~MetricsReporter();
+
+  MetricsReporter(const MetricsReporter&) = delete;
+  MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+private:
+  void run();
+  void writeReport();
+
+  // How often the thread checks whether a signal arrived
+  static constexpr auto SIGNAL_POLL_INTERVAL = std::chrono::milliseconds{100};
+
+  EventMetrics& mMetrics;
+  std::ostream& mStream;
+  const MetricsFormat mFormat;
+  const std::chrono::milliseconds mInterval;
+
+  std::mutex mMutex;
+  std::condition_variable mStopCondition;
+  bool mStopRequested = false;
+
+  std::thread mThread;
+};
+
+} // namespace variant_talk
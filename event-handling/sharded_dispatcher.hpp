@@ -0,0 +1,312 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "back_off.hpp"
+#include "event.hpp"
+#include "event_metrics.hpp"
+#include "event_queue.hpp"
+#include "wakeup_signal.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+struct ShardingPolicy
+{
+  // Events with the same key are handled by the same shard, in the order they
+  // were dispatched (e.g. a device or window id)
+  std::function<std::uint64_t(const Event&)> mKeyOf;
+
+  // Global events act as a barrier across all shards, see ShardedDispatcher
+  std::function<bool(const Event&)> mIsGlobal;
+};
+
+
+// Waits until a fixed number of threads have arrived, then releases all of
+// them. Reusable.
+class ShardBarrier
+{
+public:
+  explicit ShardBarrier(const std::size_t numParticipants)
+    : mNumParticipants(numParticipants)
+  {
+  }
+
+  void arriveAndWait(const BackOffStrategy strategy)
+  {
+    const auto generation = mGeneration.load(std::memory_order_acquire);
+
+    if (mNumArrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        mNumParticipants)
+    {
+      // Nobody can arrive again before the generation changes, so it's safe to
+      // reset the count first.
+      mNumArrived.store(0, std::memory_order_relaxed);
+      mGeneration.fetch_add(1, std::memory_order_release);
+      mReleased.notifyAll();
+      return;
+    }
+
+    waitUntil(
+      [&]()
+      {
+        return mGeneration.load(std::memory_order_acquire) != generation;
+      },
+      strategy,
+      mReleased);
+  }
+
+private:
+  const std::size_t mNumParticipants;
+  std::atomic<std::size_t> mNumArrived{0};
+  std::atomic<std::uint64_t> mGeneration{0};
+  WakeupSignal mReleased;
+};
+
+
+// Distributes events across a number of worker threads ("shards"), each with
+// its own instance of Handler (any class with an onEvent(const Event&) member
+// function, like ExampleEventHandler).
+//
+// The shard for an event is chosen by its key, so events with the same key
+// are handled in order, while events with different keys can be handled in
+// parallel. Global events are handled by every shard, with a barrier around
+// them: all events dispatched before a global event are handled before any
+// shard handles it, and no events dispatched after it are handled before all
+// shards are done with it.
+//
+// dispatch() must only be called from one thread at a time, since otherwise
+// the shards could see global events in different orders.
+template <typename Handler>
+class ShardedDispatcher
+{
+public:
+  using HandlerFactory =
+    std::function<std::unique_ptr<Handler>(std::size_t shardIndex)>;
+
+  // If pMetrics is given, the shards record the latency of the events they
+  // handle there.
+  ShardedDispatcher(
+    std::size_t numShards,
+    const HandlerFactory& createHandler,
+    ShardingPolicy policy,
+    BackOffStrategy backOffStrategy,
+    std::size_t queueCapacityPerShard = 4096,
+    EventMetrics* pMetrics = nullptr);
+  ~ShardedDispatcher();
+
+  ShardedDispatcher(const ShardedDispatcher&) = delete;
+  ShardedDispatcher& operator=(const ShardedDispatcher&) = delete;
+
+  // Waits for room in the shard's queue if it's full.
+  void dispatch(const TimestampedEvent& event);
+
+  // Handles all events which were already dispatched, then stops the shards.
+  void stop();
+
+  std::size_t numShards() const
+  {
+    return mShards.size();
+  }
+
+  Handler& handler(const std::size_t shardIndex)
+  {
+    return *mShards[shardIndex]->mpHandler;
+  }
+
+private:
+  struct Item
+  {
+    TimestampedEvent mEvent;
+    bool mIsGlobal = false;
+  };
+
+  struct Shard
+  {
+    explicit Shard(const std::size_t queueCapacity)
+      : mQueue(queueCapacity)
+    {
+    }
+
+    BoundedMpscQueue<Item> mQueue;
+    std::unique_ptr<Handler> mpHandler;
+    std::thread mThread;
+  };
+
+  void run(Shard& shard);
+  void handle(Shard& shard, const Item& item);
+
+  static constexpr std::size_t BATCH_SIZE = 256;
+
+  ShardingPolicy mPolicy;
+  BackOffStrategy mBackOffStrategy;
+  EventMetrics* mpMetrics;
+
+  ShardBarrier mBarrier;
+  std::atomic<bool> mStopRequested{false};
+  std::vector<std::unique_ptr<Shard>> mShards;
+};
+
+
+template <typename Handler>
+ShardedDispatcher<Handler>::ShardedDispatcher(
+  const std::size_t numShards,
+  const HandlerFactory& createHandler,
+  ShardingPolicy policy,
+  const BackOffStrategy backOffStrategy,
+  const std::size_t queueCapacityPerShard,
+  EventMetrics* pMetrics
+)
+  : mPolicy(std::move(policy))
+  , mBackOffStrategy(backOffStrategy)
+  , mpMetrics(pMetrics)
+  , mBarrier(numShards)
+{
+  for (auto i = std::size_t{0}; i < numShards; ++i)
+  {
+    auto pShard = std::make_unique<Shard>(queueCapacityPerShard);
+    pShard->mpHandler = createHandler(i);
+    mShards.push_back(std::move(pShard));
+  }
+
+  // Only start the threads once all shards exist, since the barrier needs
+  // all of them
+  for (auto& pShard : mShards)
+  {
+    pShard->mThread = std::thread{[this, &shard = *pShard]() { run(shard); }};
+  }
+}
+
+
+template <typename Handler>
+ShardedDispatcher<Handler>::~ShardedDispatcher()
+{
+  stop();
+}
+
+
+template <typename Handler>
+void ShardedDispatcher<Handler>::dispatch(const TimestampedEvent& event)
+{
+  if (mPolicy.mIsGlobal && mPolicy.mIsGlobal(event.mEvent))
+  {
+    for (auto& pShard : mShards)
+    {
+      pShard->mQueue.push(Item{event, true}, mBackOffStrategy);
+    }
+
+    return;
+  }
+
+  // Mix the key, so that keys which are multiples of the number of shards
+  // still spread evenly
+  const auto key = mPolicy.mKeyOf ? mPolicy.mKeyOf(event.mEvent) : 0;
+  const auto mixedKey = (key * 0x9E37'79B9'7F4A'7C15ull) >> 32;
+
+  mShards[mixedKey % mShards.size()]->mQueue.push(
+    Item{event, false}, mBackOffStrategy);
+}
+
+
+template <typename Handler>
+void ShardedDispatcher<Handler>::stop()
+{
+  if (mStopRequested.exchange(true, std::memory_order_acq_rel))
+  {
+    return;
+  }
+
+  for (auto& pShard : mShards)
+  {
+    pShard->mQueue.wakeConsumer();
+  }
+
+  for (auto& pShard : mShards)
+  {
+    pShard->mThread.join();
+  }
+}
+
+
+template <typename Handler>
+void ShardedDispatcher<Handler>::run(Shard& shard)
+{
+  auto handleItem = [&](const Item& item)
+  {
+    handle(shard, item);
+  };
+
+  for (;;)
+  {
+    if (shard.mQueue.popBatch(handleItem, BATCH_SIZE) > 0)
+    {
+      continue;
+    }
+
+    if (mStopRequested.load(std::memory_order_acquire))
+    {
+      // Every shard sees the same global events, so draining can't leave
+      // another shard stuck at a barrier.
+      while (shard.mQueue.popBatch(handleItem, BATCH_SIZE) > 0)
+      {
+      }
+
+      return;
+    }
+
+    shard.mQueue.waitForData(mBackOffStrategy, mStopRequested);
+  }
+}
+
+
+template <typename Handler>
+void ShardedDispatcher<Handler>::handle(Shard& shard, const Item& item)
+{
+  if (item.mIsGlobal)
+  {
+    mBarrier.arriveAndWait(mBackOffStrategy);
+  }
+
+  shard.mpHandler->onEvent(item.mEvent.mEvent);
+
+  // Global events are only recorded once, by the first shard
+  if (mpMetrics && (!item.mIsGlobal || &shard == mShards.front().get()))
+  {
+    mpMetrics->recordHandled(item.mEvent, EventClock::now());
+  }
+
+  if (item.mIsGlobal)
+  {
+    mBarrier.arriveAndWait(mBackOffStrategy);
+  }
+}
+
+} // namespace variant_talk
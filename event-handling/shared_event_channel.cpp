@@ -0,0 +1,319 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "shared_event_channel.hpp"
+
+#include "event_queue.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+namespace
+{
+
+constexpr std::uint64_t RING_MAGIC = 0x5654'4556'5249'4E47; // "VTEVRING"
+
+
+[[noreturn]] void fail(const std::string& name, const char* what)
+{
+  throw std::runtime_error{
+    "Shared event channel '" + name + "': " + what + " failed (errno " +
+    std::to_string(errno) + ")"};
+}
+
+
+std::size_t mappingSize(const std::uint64_t capacity)
+{
+  return sizeof(SharedEventRing) +
+    static_cast<std::size_t>(capacity) * sizeof(SharedEventSlot);
+}
+
+
+std::uint32_t* futexAddress(std::atomic<std::uint32_t>& value)
+{
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+  return reinterpret_cast<std::uint32_t*>(&value);
+}
+
+} // namespace
+
+
+SharedRingMapping::SharedRingMapping(
+  const std::string& name,
+  const std::size_t minCapacity)
+{
+  const auto capacity = detail::nextPowerOfTwo(minCapacity);
+  mSize = mappingSize(capacity);
+
+  // Start from scratch, in case a previous publisher crashed
+  ::shm_unlink(name.c_str());
+
+  const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1)
+  {
+    fail(name, "shm_open");
+  }
+
+  if (::ftruncate(fd, static_cast<off_t>(mSize)) == -1)
+  {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    fail(name, "ftruncate");
+  }
+
+  auto pMapping =
+    ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    ::shm_unlink(name.c_str());
+    fail(name, "mmap");
+  }
+
+  // The object is zero-filled by ftruncate, so only the non-zero fields need
+  // to be set.
+  mpRing = static_cast<SharedEventRing*>(pMapping);
+  mpRing->mCapacity = capacity;
+  mpRing->mPublisherPid = ::getpid();
+  mpRing->mMagic.store(RING_MAGIC, std::memory_order_release);
+}
+
+
+SharedRingMapping::SharedRingMapping(const std::string& name)
+{
+  const auto fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1)
+  {
+    fail(name, "shm_open");
+  }
+
+  struct stat objectStatus;
+  if (::fstat(fd, &objectStatus) == -1)
+  {
+    ::close(fd);
+    fail(name, "fstat");
+  }
+
+  const auto size = static_cast<std::size_t>(objectStatus.st_size);
+  if (size < sizeof(SharedEventRing))
+  {
+    ::close(fd);
+    throw std::runtime_error{"'" + name + "' is not a shared event channel"};
+  }
+
+  auto pMapping =
+    ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    fail(name, "mmap");
+  }
+
+  mpRing = static_cast<SharedEventRing*>(pMapping);
+  mSize = size;
+
+  if (
+    mpRing->mMagic.load(std::memory_order_acquire) != RING_MAGIC ||
+    mappingSize(mpRing->mCapacity) != mSize)
+  {
+    ::munmap(pMapping, mSize);
+    throw std::runtime_error{"'" + name + "' is not a shared event channel"};
+  }
+}
+
+
+SharedRingMapping::~SharedRingMapping()
+{
+  ::munmap(mpRing, mSize);
+}
+
+} // namespace detail
+
+
+SharedEventPublisher::SharedEventPublisher(
+  const std::string& name,
+  const std::size_t minCapacity
+)
+  : mName(name)
+  , mMapping(name, minCapacity)
+{
+}
+
+
+SharedEventPublisher::~SharedEventPublisher()
+{
+  auto& ring = mMapping.ring();
+
+  ring.mIsClosed.store(1, std::memory_order_release);
+  ring.mWakeupEpoch.fetch_add(1, std::memory_order_release);
+  syscall(
+    SYS_futex,
+    detail::futexAddress(ring.mWakeupEpoch),
+    FUTEX_WAKE,
+    INT_MAX,
+    nullptr,
+    nullptr,
+    0);
+
+  ::shm_unlink(mName.c_str());
+}
+
+
+void SharedEventPublisher::publish(const TimestampedEvent& event)
+{
+  auto& ring = mMapping.ring();
+
+  // Only this process writes the position, so there's no need for a
+  // read-modify-write operation.
+  const auto pos = ring.mWritePos.load(std::memory_order_relaxed);
+  auto& slot = ring.slotFor(pos);
+
+  slot.mSequence.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&slot.mEvent, &event, sizeof(event));
+  slot.mSequence.store(2 * pos + 2, std::memory_order_release);
+
+  ring.mWritePos.store(pos + 1, std::memory_order_seq_cst);
+
+  // Pairs with the subscriber's increment of mNumWaiters, see waitForData()
+  if (ring.mNumWaiters.load(std::memory_order_seq_cst) > 0)
+  {
+    ring.mWakeupEpoch.fetch_add(1, std::memory_order_release);
+    syscall(
+      SYS_futex,
+      detail::futexAddress(ring.mWakeupEpoch),
+      FUTEX_WAKE,
+      INT_MAX,
+      nullptr,
+      nullptr,
+      0);
+  }
+}
+
+
+SharedEventSubscriber::SharedEventSubscriber(const std::string& name)
+  : mMapping(name)
+  , mReadPos(mMapping.ring().mWritePos.load(std::memory_order_acquire))
+{
+}
+
+
+void SharedEventSubscriber::waitForData(
+  const std::chrono::milliseconds timeout)
+{
+  auto& ring = mMapping.ring();
+
+  ring.mNumWaiters.fetch_add(1, std::memory_order_seq_cst);
+  const auto epoch = ring.mWakeupEpoch.load(std::memory_order_seq_cst);
+
+  const auto hasData =
+    ring.mWritePos.load(std::memory_order_seq_cst) != mReadPos ||
+    ring.mIsClosed.load(std::memory_order_acquire);
+
+  if (!hasData)
+  {
+    const auto seconds =
+      std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    const auto nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds);
+
+    timespec relativeTimeout;
+    relativeTimeout.tv_sec = static_cast<std::time_t>(seconds.count());
+    relativeTimeout.tv_nsec = static_cast<long>(nanoseconds.count());
+
+    // Returns immediately if the epoch has changed since we read it
+    syscall(
+      SYS_futex,
+      detail::futexAddress(ring.mWakeupEpoch),
+      FUTEX_WAIT,
+      epoch,
+      &relativeTimeout,
+      nullptr,
+      0);
+  }
+
+  ring.mNumWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+bool SharedEventSubscriber::isClosed() const
+{
+  auto& ring = mMapping.ring();
+
+  return
+    ring.mIsClosed.load(std::memory_order_acquire) &&
+    ring.mWritePos.load(std::memory_order_acquire) == mReadPos;
+}
+
+
+bool SharedEventSubscriber::hasPublisherDied() const
+{
+  auto& ring = mMapping.ring();
+
+  // Signal 0 only checks whether the process exists. A crashed publisher
+  // which hasn't been reaped by its parent yet still counts as alive.
+  const auto pid = static_cast<pid_t>(ring.mPublisherPid);
+  const auto isAlive = ::kill(pid, 0) == 0 || errno == EPERM;
+
+  // The publisher closes the channel before it exits, so checking this after
+  // the pid tells a crash apart from a regular shutdown.
+  return !isAlive && !ring.mIsClosed.load(std::memory_order_acquire);
+}
+
+
+void SharedEventSubscriber::skipToOldestAvailable()
+{
+  auto& ring = mMapping.ring();
+
+  // Leave some distance to the publisher, so that the new position isn't
+  // overwritten again right away.
+  const auto writePos = ring.mWritePos.load(std::memory_order_acquire);
+  const auto margin = ring.mCapacity / 8 + 1;
+  const auto oldestAvailable =
+    writePos > ring.mCapacity ? writePos - ring.mCapacity + margin : 0;
+
+  if (oldestAvailable > mReadPos)
+  {
+    mNumLostEvents += oldestAvailable - mReadPos;
+    mReadPos = oldestAvailable;
+  }
+}
+
+} // namespace variant_talk
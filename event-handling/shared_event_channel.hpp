@@ -0,0 +1,260 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "event.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+struct SharedEventRing;
+
+
+// Mapping of a shared memory object holding a SharedEventRing
+class SharedRingMapping
+{
+public:
+  SharedRingMapping(const std::string& name, std::size_t minCapacity);
+  explicit SharedRingMapping(const std::string& name);
+  ~SharedRingMapping();
+
+  SharedRingMapping(const SharedRingMapping&) = delete;
+  SharedRingMapping& operator=(const SharedRingMapping&) = delete;
+
+  SharedEventRing& ring() const
+  {
+    return *mpRing;
+  }
+
+private:
+  SharedEventRing* mpRing = nullptr;
+  std::size_t mSize = 0;
+};
+
+} // namespace detail
+
+
+// Broadcasts events from one process to any number of other processes, via a
+// ring buffer in POSIX shared memory (Linux only).
+//
+// Events are copied into the ring as they are, without any serialization, so
+// all processes must run the same build. Timestamps are taken from
+// steady_clock, which is system wide on Linux, so latency can be measured
+// across processes.
+//
+// The publisher never waits for subscribers. Each slot is protected by a
+// sequence number (like a seqlock): a subscriber which falls behind by more
+// than the ring's capacity notices that its next slot was overwritten, skips
+// ahead to the oldest event still available, and counts the ones it lost.
+// Idle subscribers sleep on a futex in the shared memory, which the publisher
+// only wakes if somebody is actually waiting.
+class SharedEventPublisher
+{
+public:
+  // Creates the shared memory object, replacing any existing one of the same
+  // name. The name must start with a slash, e.g. "/variant-talk-events".
+  // Throws std::runtime_error on failure.
+  SharedEventPublisher(const std::string& name, std::size_t minCapacity);
+
+  // Tells subscribers that no more events will come, and removes the name.
+  // Subscribers which are already attached keep their mapping.
+  ~SharedEventPublisher();
+
+  SharedEventPublisher(const SharedEventPublisher&) = delete;
+  SharedEventPublisher& operator=(const SharedEventPublisher&) = delete;
+
+  void publish(const TimestampedEvent& event);
+
+private:
+  std::string mName;
+  detail::SharedRingMapping mMapping;
+};
+
+
+class SharedEventSubscriber
+{
+public:
+  // Attaches to the publisher's shared memory object. Only events published
+  // from now on are received. Throws std::runtime_error on failure.
+  explicit SharedEventSubscriber(const std::string& name);
+
+  // Invokes consume(const TimestampedEvent&) for up to maxCount events, in
+  // the order they were published, and returns how many were consumed.
+  template <typename Consumer>
+  std::size_t popBatch(Consumer&& consume, std::size_t maxCount);
+
+  // Waits until an event might be available, the publisher closed the
+  // channel, or the timeout expires.
+  void waitForData(std::chrono::milliseconds timeout);
+
+  // True once the publisher is gone and all its events have been consumed
+  bool isClosed() const;
+
+  // True if the publisher process has exited without closing the channel,
+  // e.g. because it crashed. Relies on the publisher's pid, so both processes
+  // must be in the same pid namespace.
+  bool hasPublisherDied() const;
+
+  std::uint64_t numLostEvents() const
+  {
+    return mNumLostEvents;
+  }
+
+private:
+  enum class ReadResult
+  {
+    Ok,
+    NotYetPublished,
+    Overwritten
+  };
+
+  ReadResult tryRead(TimestampedEvent& event) const;
+  void skipToOldestAvailable();
+
+  detail::SharedRingMapping mMapping;
+  std::uint64_t mReadPos;
+  std::uint64_t mNumLostEvents = 0;
+};
+
+
+namespace detail
+{
+
+constexpr std::size_t SHARED_CACHE_LINE_SIZE = 64;
+
+static_assert(
+  std::atomic<std::uint64_t>::is_always_lock_free &&
+  std::atomic<std::uint32_t>::is_always_lock_free,
+  "Atomics in shared memory must be lock-free");
+
+
+struct SharedEventSlot
+{
+  // 2 * position + 1 while the slot is being written, 2 * position + 2 once
+  // the event at position is complete
+  std::atomic<std::uint64_t> mSequence;
+  TimestampedEvent mEvent;
+};
+
+
+static_assert(
+  std::is_trivially_copyable_v<TimestampedEvent>,
+  "Events are copied into shared memory as raw bytes");
+
+
+// Lives at the start of the shared memory object, followed by the slots.
+struct SharedEventRing
+{
+  // Written last by the publisher, once everything else is initialized
+  std::atomic<std::uint64_t> mMagic;
+  std::uint64_t mCapacity;
+  std::int64_t mPublisherPid;
+
+  alignas(SHARED_CACHE_LINE_SIZE) std::atomic<std::uint64_t> mWritePos;
+  std::atomic<std::uint32_t> mIsClosed;
+
+  alignas(SHARED_CACHE_LINE_SIZE) std::atomic<std::uint32_t> mWakeupEpoch;
+  std::atomic<std::uint32_t> mNumWaiters;
+
+  SharedEventSlot& slotFor(const std::uint64_t position)
+  {
+    const auto pSlots = reinterpret_cast<SharedEventSlot*>(
+      reinterpret_cast<unsigned char*>(this) + sizeof(SharedEventRing));
+    return pSlots[position & (mCapacity - 1)];
+  }
+};
+
+} // namespace detail
+
+
+template <typename Consumer>
+std::size_t SharedEventSubscriber::popBatch(
+  Consumer&& consume,
+  const std::size_t maxCount)
+{
+  auto count = std::size_t{0};
+  TimestampedEvent event;
+
+  while (count < maxCount)
+  {
+    const auto result = tryRead(event);
+
+    if (result == ReadResult::NotYetPublished)
+    {
+      break;
+    }
+    else if (result == ReadResult::Overwritten)
+    {
+      skipToOldestAvailable();
+      continue;
+    }
+
+    ++mReadPos;
+    ++count;
+    consume(event);
+  }
+
+  return count;
+}
+
+
+inline auto SharedEventSubscriber::tryRead(TimestampedEvent& event) const
+  -> ReadResult
+{
+  auto& slot = mMapping.ring().slotFor(mReadPos);
+  const auto expectedSequence = 2 * mReadPos + 2;
+
+  const auto sequenceBefore = slot.mSequence.load(std::memory_order_acquire);
+  if (sequenceBefore < expectedSequence)
+  {
+    return ReadResult::NotYetPublished;
+  }
+  else if (sequenceBefore > expectedSequence)
+  {
+    return ReadResult::Overwritten;
+  }
+
+  std::memcpy(&event, &slot.mEvent, sizeof(event));
+
+  // If the publisher started overwriting the slot while we were copying, the
+  // copy might be torn.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const auto sequenceAfter = slot.mSequence.load(std::memory_order_relaxed);
+
+  return sequenceAfter == expectedSequence
+    ? ReadResult::Ok
+    : ReadResult::Overwritten;
+}
+
+} // namespace variant_talk
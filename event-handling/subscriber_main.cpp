@@ -0,0 +1,176 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Consumer process for events published by event_handling --publish, via a
+// SharedEventSubscriber. Runs its own ExampleEventHandler, and reports
+// latency from the time the input process received each event.
+
+#include "async_logger.hpp"
+#include "event_metrics.hpp"
+#include "handler.hpp"
+#include "metrics_reporter.hpp"
+#include "shared_event_channel.hpp"
+
+#include "match.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+using namespace variant_talk;
+
+namespace
+{
+
+constexpr std::size_t BATCH_SIZE = 256;
+constexpr auto WAIT_TIMEOUT = std::chrono::milliseconds{100};
+
+
+void run(
+  const std::string& channelName,
+  const MetricsFormat metricsFormat,
+  const std::chrono::milliseconds metricsInterval)
+{
+  SharedEventSubscriber subscriber{channelName};
+
+  AsyncLogger log{std::cout};
+  ExampleEventHandler handler{log};
+
+  EventMetrics metrics;
+  MetricsReporter reporter{metrics, std::cerr, metricsFormat, metricsInterval};
+
+  auto handleEvent = [&](const TimestampedEvent& event)
+  {
+    handler.onEvent(event.mEvent);
+    metrics.recordHandled(event, EventClock::now());
+  };
+
+  while (!subscriber.isClosed())
+  {
+    if (subscriber.popBatch(handleEvent, BATCH_SIZE) == 0)
+    {
+      // Without this, a crashed publisher would leave us waiting forever
+      if (subscriber.hasPublisherDied())
+      {
+        throw std::runtime_error{
+          "publisher exited without closing the channel, " +
+          std::to_string(subscriber.numLostEvents()) + " events lost"};
+      }
+
+      subscriber.waitForData(WAIT_TIMEOUT);
+    }
+  }
+
+  std::cerr << "publisher closed the channel, " <<
+    subscriber.numLostEvents() << " events lost\n";
+}
+
+
+// Returns nothing unless all of the text is a number of at least minValue
+std::optional<long> parseInteger(std::string_view text, const long minValue)
+{
+  const auto string = std::string{text};
+
+  try
+  {
+    std::size_t length = 0;
+    const auto number = std::stol(string, &length);
+    if (length == string.size() && number >= minValue)
+    {
+      return number;
+    }
+  }
+  catch (const std::logic_error&)
+  {
+  }
+
+  return std::nullopt;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  std::string channelName;
+  auto metricsFormat = MetricsFormat::Text;
+  auto metricsInterval = std::chrono::milliseconds{0};
+
+  for (auto i = 1; i < argc; ++i)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string_view{i + 1 < argc ? argv[i + 1] : ""};
+    const auto maybeInterval = parseInteger(value, 0);
+
+    if (arg == "--channel" && !value.empty())
+    {
+      channelName = value;
+      ++i;
+    }
+    else if (
+      arg == "--metrics-format" && (value == "text" || value == "json"))
+    {
+      metricsFormat =
+        value == "json" ? MetricsFormat::Json : MetricsFormat::Text;
+      ++i;
+    }
+    else if (arg == "--metrics-interval" && maybeInterval)
+    {
+      metricsInterval = std::chrono::milliseconds{*maybeInterval};
+      ++i;
+    }
+    else
+    {
+      channelName.clear();
+      break;
+    }
+  }
+
+  if (channelName.empty())
+  {
+    std::cerr <<
+      "Usage: event_handling_subscriber --channel name "
+      "[--metrics-interval milliseconds]\n"
+      "                                 [--metrics-format text|json]\n";
+    return 1;
+  }
+
+  try
+  {
+    run(channelName, metricsFormat, metricsInterval);
+  }
+  catch (const std::exception& error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  printMatchStatistics(std::cerr);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "wakeup_signal.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#endif
+
+
+namespace variant_talk
+{
+
+#if defined(__linux__)
+
+namespace
+{
+
+std::uint32_t* futexAddress(std::atomic<std::uint32_t>& value)
+{
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+  return reinterpret_cast<std::uint32_t*>(&value);
+}
+
+} // namespace
+
+
+void WakeupSignal::wait(const Ticket ticket)
+{
+  while (mEpoch.load(std::memory_order_acquire) == ticket)
+  {
+    // Returns immediately if the epoch has already changed. Spurious wake-ups
+    // and interruptions are handled by the loop.
+    syscall(
+      SYS_futex,
+      futexAddress(mEpoch),
+      FUTEX_WAIT_PRIVATE,
+      ticket,
+      nullptr,
+      nullptr,
+      0);
+  }
+
+  mNumWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+void WakeupSignal::wakeWaiters()
+{
+  mEpoch.fetch_add(1, std::memory_order_release);
+
+  syscall(
+    SYS_futex,
+    futexAddress(mEpoch),
+    FUTEX_WAKE_PRIVATE,
+    INT_MAX,
+    nullptr,
+    nullptr,
+    0);
+}
+
+#else
+
+void WakeupSignal::wait(const Ticket ticket)
+{
+  {
+    std::unique_lock<std::mutex> lock{mMutex};
+    mCondition.wait(lock, [&]()
+    {
+      return mEpoch.load(std::memory_order_acquire) != ticket;
+    });
+  }
+
+  mNumWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+void WakeupSignal::wakeWaiters()
+{
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    mEpoch.fetch_add(1, std::memory_order_release);
+  }
+
+  mCondition.notify_all();
+}
+
+#endif
+
+} // namespace variant_talk
@@ -0,0 +1,98 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+
+namespace variant_talk
+{
+
+// Lets threads sleep until another thread signals that something changed
+// (an "event count"). Notifying is cheap when nobody is waiting.
+//
+// To avoid missing a notification, waiting is a two step process:
+//
+//   const auto ticket = signal.prepareWait();
+//   if (conditionIsTrue()) { signal.cancelWait(); } else { signal.wait(ticket); }
+//
+// On Linux, this is implemented with a futex, elsewhere with a condition
+// variable.
+class WakeupSignal
+{
+public:
+  using Ticket = std::uint32_t;
+
+  Ticket prepareWait();
+  void cancelWait();
+  void wait(Ticket ticket);
+
+  void notifyAll();
+
+private:
+  void wakeWaiters();
+
+  std::atomic<std::uint32_t> mEpoch{0};
+  std::atomic<std::uint32_t> mNumWaiters{0};
+
+#if !defined(__linux__)
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+#endif
+};
+
+
+inline auto WakeupSignal::prepareWait() -> Ticket
+{
+  mNumWaiters.fetch_add(1, std::memory_order_seq_cst);
+  const auto ticket = mEpoch.load(std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  return ticket;
+}
+
+
+inline void WakeupSignal::cancelWait()
+{
+  mNumWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+inline void WakeupSignal::notifyAll()
+{
+  // Orders the caller's preceding writes before the check for waiters, the
+  // counterpart to the fence in prepareWait().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (mNumWaiters.load(std::memory_order_relaxed) != 0)
+  {
+    wakeWaiters();
+  }
+}
+
+} // namespace variant_talk
@@ -21,7 +21,8 @@
 
 #pragma once
 
-#include <variant>
+#include "compact_variant.hpp"
+
 #include <vector>
 
 
@@ -81,7 +82,7 @@ struct Jump
 };
 
 
-using OpCode = std::variant<
+using OpCode = compact_variant<
   Inc,
   Dec,
   Load,
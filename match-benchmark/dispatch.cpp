@@ -0,0 +1,179 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Benchmark program for a single combination of number of alternatives and
+// dispatch implementation. It is compiled by the match_benchmark driver (see
+// driver.cpp) once per combination, with the following definitions:
+//
+//   NUM_ALTERNATIVES   - number of alternatives in the variant
+//   MATCHER_BODY_SIZE  - number of arithmetic steps in each matcher's body
+//   DISPATCH_STD_VISIT - match() on a std::variant, i.e. std::visit
+//   DISPATCH_FOLD      - foldMatch() on a std::variant
+//   DISPATCH_SWITCH    - switchMatch() on a std::variant
+//   DISPATCH_COMPACT   - match() on a compact_variant
+//
+// When run, it prints the average time per dispatch in nanoseconds.
+
+#include "compact_variant.hpp"
+#include "dispatch_impls.hpp"
+#include "match.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+#ifndef NUM_ALTERNATIVES
+#define NUM_ALTERNATIVES 4
+#endif
+
+#ifndef MATCHER_BODY_SIZE
+#define MATCHER_BODY_SIZE 1
+#endif
+
+
+using namespace variant_talk;
+
+namespace
+{
+
+constexpr auto NUM_VALUES = 1u << 16;
+constexpr auto NUM_ITERATIONS = 200u;
+
+
+template <std::size_t I>
+struct Alternative
+{
+  std::uint32_t value;
+};
+
+
+template <typename IndexSequence>
+struct VariantFor;
+
+template <std::size_t... Is>
+struct VariantFor<std::index_sequence<Is...>>
+{
+#if defined(DISPATCH_COMPACT)
+  using type = compact_variant<Alternative<Is>...>;
+#else
+  using type = std::variant<Alternative<Is>...>;
+#endif
+};
+
+using Indices = std::make_index_sequence<NUM_ALTERNATIVES>;
+using Variant = VariantFor<Indices>::type;
+
+
+// Mixes shifts, xors and multiplications, so that the compiler can't fold
+// consecutive steps into one. The code size of a matcher thus grows linearly
+// with the number of steps.
+template <std::size_t I, std::size_t... Steps>
+std::uint32_t matcherBody(std::uint32_t value, std::index_sequence<Steps...>)
+{
+  ((value = (value ^ (value >> 13)) *
+     static_cast<std::uint32_t>(2 * (I + Steps) + 1)),
+   ...);
+  return value;
+}
+
+
+// Each instantiation yields a distinct closure type, so this creates matchers
+// equivalent to writing out one lambda per alternative by hand.
+template <std::size_t I>
+auto makeMatcher()
+{
+  return [](const Alternative<I>& alternative) -> std::uint32_t
+  {
+    return matcherBody<I>(
+      alternative.value, std::make_index_sequence<MATCHER_BODY_SIZE>{});
+  };
+}
+
+
+template <std::size_t... Is>
+std::uint32_t dispatch(const Variant& variant, std::index_sequence<Is...>)
+{
+#if defined(DISPATCH_FOLD)
+  return foldMatch(variant, makeMatcher<Is>()...);
+#elif defined(DISPATCH_SWITCH)
+  return switchMatch(variant, makeMatcher<Is>()...);
+#else
+  return match(variant, makeMatcher<Is>()...);
+#endif
+}
+
+
+template <std::size_t... Is>
+Variant makeVariant(
+  const std::size_t index,
+  const std::uint32_t value,
+  std::index_sequence<Is...>)
+{
+  using Factory = Variant (*)(std::uint32_t);
+  constexpr Factory factories[] = {
+    [](const std::uint32_t v) { return Variant{Alternative<Is>{v}}; }...};
+
+  return factories[index](value);
+}
+
+} // namespace
+
+
+int main()
+{
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<std::size_t> indexDistribution{
+    0, NUM_ALTERNATIVES - 1};
+  std::uniform_int_distribution<std::uint32_t> valueDistribution{0, 1000};
+
+  std::vector<Variant> values;
+  values.reserve(NUM_VALUES);
+  for (auto i = 0u; i < NUM_VALUES; ++i)
+  {
+    values.push_back(makeVariant(
+      indexDistribution(generator), valueDistribution(generator), Indices{}));
+  }
+
+  namespace cr = std::chrono;
+  using Clock = cr::steady_clock;
+
+  auto checksum = std::uint32_t{0};
+
+  const auto start = Clock::now();
+  for (auto iteration = 0u; iteration < NUM_ITERATIONS; ++iteration)
+  {
+    for (const auto& value : values)
+    {
+      checksum += dispatch(value, Indices{});
+    }
+  }
+  const auto elapsed = cr::duration<double, std::nano>{Clock::now() - start};
+
+  // The checksum is printed so that the loop can't be optimized away.
+  std::cout << elapsed.count() / (double{NUM_VALUES} * NUM_ITERATIONS)
+    << ' ' << checksum << '\n';
+}
@@ -0,0 +1,151 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "match.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+
+// Alternative implementations of match(), to compare against std::visit in
+// the benchmark. Both only support std::variant, and matchers returning a
+// default constructible type.
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+template <typename Visitor, typename Variant, std::size_t... Is>
+auto foldVisit(
+  Visitor& visitor,
+  const Variant& variant,
+  std::index_sequence<Is...>)
+{
+  using Result = std::invoke_result_t<
+    Visitor&, const std::variant_alternative_t<0, Variant>&>;
+
+  Result result{};
+
+  // Short-circuits after the first matching index
+  ((variant.index() == Is &&
+    (result = visitor(*std::get_if<Is>(&variant)), true)) || ...);
+
+  return result;
+}
+
+
+#define VARIANT_TALK_CASE(index) \
+  case index: \
+    if constexpr ((index) < std::variant_size_v<Variant>) \
+    { \
+      return visitor(*std::get_if<(index)>(&variant)); \
+    } \
+    else \
+    { \
+      break; \
+    }
+
+#define VARIANT_TALK_CASES_4(start) \
+  VARIANT_TALK_CASE(start) \
+  VARIANT_TALK_CASE(start + 1) \
+  VARIANT_TALK_CASE(start + 2) \
+  VARIANT_TALK_CASE(start + 3)
+
+#define VARIANT_TALK_CASES_16(start) \
+  VARIANT_TALK_CASES_4(start) \
+  VARIANT_TALK_CASES_4(start + 4) \
+  VARIANT_TALK_CASES_4(start + 8) \
+  VARIANT_TALK_CASES_4(start + 12)
+
+#define VARIANT_TALK_CASES_64(start) \
+  VARIANT_TALK_CASES_16(start) \
+  VARIANT_TALK_CASES_16(start + 16) \
+  VARIANT_TALK_CASES_16(start + 32) \
+  VARIANT_TALK_CASES_16(start + 48)
+
+#define VARIANT_TALK_CASES_256(start) \
+  VARIANT_TALK_CASES_64(start) \
+  VARIANT_TALK_CASES_64(start + 64) \
+  VARIANT_TALK_CASES_64(start + 128) \
+  VARIANT_TALK_CASES_64(start + 192)
+
+
+constexpr auto MAX_SWITCH_ALTERNATIVES = 256u;
+
+template <typename Visitor, typename Variant>
+auto switchVisit(Visitor& visitor, const Variant& variant)
+{
+  static_assert(
+    std::variant_size_v<Variant> <= MAX_SWITCH_ALTERNATIVES,
+    "Too many alternatives for switchVisit");
+
+  using Result = std::invoke_result_t<
+    Visitor&, const std::variant_alternative_t<0, Variant>&>;
+
+  switch (variant.index())
+  {
+    VARIANT_TALK_CASES_256(0)
+
+    default:
+      break;
+  }
+
+  return Result{};
+}
+
+#undef VARIANT_TALK_CASES_256
+#undef VARIANT_TALK_CASES_64
+#undef VARIANT_TALK_CASES_16
+#undef VARIANT_TALK_CASES_4
+#undef VARIANT_TALK_CASE
+
+} // namespace detail
+
+
+// Dispatches via a chain of index comparisons, generated by a fold expression
+template <typename Variant, typename... Matchers>
+auto foldMatch(const Variant& variant, Matchers&&... matchers)
+{
+  auto visitor = detail::overloaded{std::forward<Matchers>(matchers)...};
+
+  return detail::foldVisit(
+    visitor,
+    variant,
+    std::make_index_sequence<std::variant_size_v<Variant>>{});
+}
+
+
+// Dispatches via a switch statement over the variant's index
+template <typename Variant, typename... Matchers>
+auto switchMatch(const Variant& variant, Matchers&&... matchers)
+{
+  auto visitor = detail::overloaded{std::forward<Matchers>(matchers)...};
+
+  return detail::switchVisit(visitor, variant);
+}
+
+} // namespace variant_talk
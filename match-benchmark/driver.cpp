@@ -0,0 +1,456 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures the cost of match() and alternative dispatch implementations, for
+// variants with a growing number of alternatives, and matchers with growing
+// bodies.
+//
+// For each combination, dispatch.cpp is compiled with the same compiler which
+// was used to build this program, and the following is reported:
+//
+//   - time taken to compile the translation unit
+//   - size of the resulting object file
+//   - minimal template instantiation depth needed to compile it (optional,
+//     since this requires compiling repeatedly)
+//   - average runtime cost of a single dispatch, over random alternatives
+//
+// The depth search takes a handful of compiler runs per combination. It is
+// skipped for combinations which take longer than
+// MAX_DEPTH_SEARCH_COMPILE_SECONDS to compile (e.g. std::visit with 256
+// alternatives), and reported as "-" like a failure.
+//
+// Usage:
+//   match_benchmark [--sizes 4,8,...] [--bodies 1,16,...]
+//                   [--impls std_visit,fold,...] [--depth] [--csv]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+struct Implementation
+{
+  const char* mName;
+  const char* mDefine;
+};
+
+
+const Implementation IMPLEMENTATIONS[] = {
+  {"std_visit", "DISPATCH_STD_VISIT"},
+  {"fold", "DISPATCH_FOLD"},
+  {"switch", "DISPATCH_SWITCH"},
+  {"compact", "DISPATCH_COMPACT"},
+};
+
+
+constexpr auto INITIAL_TEMPLATE_DEPTH = 16;
+constexpr auto MAX_TEMPLATE_DEPTH = 4096;
+constexpr auto MAX_DEPTH_SEARCH_COMPILE_SECONDS = 10.0;
+
+
+struct Options
+{
+  std::vector<int> mSizes{4, 8, 16, 32, 64, 128, 256};
+  std::vector<int> mBodySizes{1};
+  std::vector<Implementation> mImplementations{
+    std::begin(IMPLEMENTATIONS), std::end(IMPLEMENTATIONS)};
+  bool mMeasureDepth = false;
+  bool mCsvOutput = false;
+};
+
+
+struct Result
+{
+  double mCompileSeconds = 0.0;
+  std::streamoff mObjectSize = 0;
+  std::optional<int> mMinTemplateDepth;
+  std::optional<double> mNanosecondsPerDispatch;
+};
+
+
+std::vector<std::string> split(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::istringstream stream{list};
+
+  for (std::string item; std::getline(stream, item, ',');)
+  {
+    items.push_back(item);
+  }
+
+  return items;
+}
+
+
+// Returns nothing if the list contains anything but positive integers.
+std::optional<std::vector<int>> parsePositiveInts(const std::string& list)
+{
+  std::vector<int> values;
+
+  for (const auto& item : split(list))
+  {
+    try
+    {
+      values.push_back(std::stoi(item));
+    }
+    catch (const std::logic_error&)
+    {
+      return std::nullopt;
+    }
+
+    if (values.back() <= 0)
+    {
+      return std::nullopt;
+    }
+  }
+
+  return values;
+}
+
+
+std::optional<Options> parseOptions(const int argc, char** argv)
+{
+  Options options;
+
+  for (auto i = 1; i < argc; ++i)
+  {
+    const auto arg = std::string{argv[i]};
+    const auto hasValue = i + 1 < argc;
+
+    if ((arg == "--sizes" || arg == "--bodies") && hasValue)
+    {
+      auto values = parsePositiveInts(argv[++i]);
+      if (!values)
+      {
+        std::cerr << "Invalid list of numbers: " << argv[i] << '\n';
+        return std::nullopt;
+      }
+
+      (arg == "--sizes" ? options.mSizes : options.mBodySizes) =
+        std::move(*values);
+    }
+    else if (arg == "--impls" && hasValue)
+    {
+      options.mImplementations.clear();
+      for (const auto& name : split(argv[++i]))
+      {
+        const auto iImpl = std::find_if(
+          std::begin(IMPLEMENTATIONS), std::end(IMPLEMENTATIONS),
+          [&](const Implementation& impl) { return name == impl.mName; });
+        if (iImpl == std::end(IMPLEMENTATIONS))
+        {
+          std::cerr << "Unknown implementation: " << name << '\n';
+          return std::nullopt;
+        }
+
+        options.mImplementations.push_back(*iImpl);
+      }
+    }
+    else if (arg == "--depth")
+    {
+      options.mMeasureDepth = true;
+    }
+    else if (arg == "--csv")
+    {
+      options.mCsvOutput = true;
+    }
+    else
+    {
+      std::cerr <<
+        "Usage: match_benchmark [--sizes 4,8,...] [--bodies 1,16,...]\n"
+        "                       [--impls std_visit,fold,switch,compact] "
+        "[--depth] [--csv]\n";
+      return std::nullopt;
+    }
+  }
+
+  return options;
+}
+
+
+struct Combination
+{
+  Implementation mImpl;
+  int mNumAlternatives;
+  int mBodySize;
+};
+
+
+std::string compileCommand(
+  const Combination& combination,
+  const std::string& extraFlags)
+{
+  std::ostringstream command;
+  command
+    << '"' << MATCH_BENCHMARK_CXX_COMPILER << "\" "
+    << MATCH_BENCHMARK_CXX_FLAGS << ' '
+    << "-I\"" << MATCH_BENCHMARK_SHARED_DIR << "\" "
+    << "-DNUM_ALTERNATIVES=" << combination.mNumAlternatives << ' '
+    << "-DMATCHER_BODY_SIZE=" << combination.mBodySize << ' '
+    << "-D" << combination.mImpl.mDefine << ' '
+    << extraFlags << ' '
+    << '"' << MATCH_BENCHMARK_SOURCE << '"';
+  return command.str();
+}
+
+
+bool runQuietly(const std::string& command)
+{
+  return std::system((command + " > /dev/null 2>&1").c_str()) == 0;
+}
+
+
+std::streamoff fileSize(const std::string& path)
+{
+  std::ifstream file{path, std::ios::binary | std::ios::ate};
+  return file ? static_cast<std::streamoff>(file.tellg()) : 0;
+}
+
+
+std::optional<double> runDispatchBenchmark(const std::string& executable)
+{
+  const auto pPipe = popen(('"' + executable + '"').c_str(), "r");
+  if (!pPipe)
+  {
+    return std::nullopt;
+  }
+
+  double nanoseconds = 0.0;
+  const auto numParsed = std::fscanf(pPipe, "%lf", &nanoseconds);
+  pclose(pPipe);
+
+  if (numParsed != 1)
+  {
+    return std::nullopt;
+  }
+
+  return nanoseconds;
+}
+
+
+// Search for the smallest -ftemplate-depth which still compiles. The depths
+// needed are usually small, so the upper bound is found by doubling from
+// INITIAL_TEMPLATE_DEPTH, followed by a binary search below it. That takes
+// far fewer compiler runs than bisecting the whole range up to
+// MAX_TEMPLATE_DEPTH.
+std::optional<int> findMinTemplateDepth(const Combination& combination)
+{
+  auto compilesWithDepth = [&](const int depth)
+  {
+    return runQuietly(compileCommand(
+      combination,
+      "-fsyntax-only -ftemplate-depth=" + std::to_string(depth)));
+  };
+
+  auto upper = INITIAL_TEMPLATE_DEPTH;
+  while (!compilesWithDepth(upper))
+  {
+    if (upper >= MAX_TEMPLATE_DEPTH)
+    {
+      return std::nullopt;
+    }
+
+    upper = std::min(upper * 2, MAX_TEMPLATE_DEPTH);
+  }
+
+  // Half of the upper bound is known not to compile, unless it's the first
+  // depth tried
+  auto lower = upper == INITIAL_TEMPLATE_DEPTH ? 1 : upper / 2 + 1;
+  while (lower < upper)
+  {
+    const auto middle = lower + (upper - lower) / 2;
+    if (compilesWithDepth(middle))
+    {
+      upper = middle;
+    }
+    else
+    {
+      lower = middle + 1;
+    }
+  }
+
+  return upper;
+}
+
+
+std::optional<Result> measure(
+  const Combination& combination,
+  const bool measureDepth)
+{
+  namespace cr = std::chrono;
+  using Clock = cr::steady_clock;
+
+  const auto baseName = std::string{MATCH_BENCHMARK_WORK_DIR} + "/dispatch_" +
+    combination.mImpl.mName + "_" +
+    std::to_string(combination.mNumAlternatives) + "_" +
+    std::to_string(combination.mBodySize);
+  const auto objectFile = baseName + ".o";
+  const auto executable = baseName;
+
+  Result result;
+
+  const auto compileStart = Clock::now();
+  if (!runQuietly(
+    compileCommand(combination, "-c -o \"" + objectFile + "\"")))
+  {
+    return std::nullopt;
+  }
+  result.mCompileSeconds =
+    cr::duration<double>{Clock::now() - compileStart}.count();
+  result.mObjectSize = fileSize(objectFile);
+
+  const auto linkCommand = std::string{"\""} + MATCH_BENCHMARK_CXX_COMPILER +
+    "\" \"" + objectFile + "\" -o \"" + executable + "\"";
+  if (runQuietly(linkCommand))
+  {
+    result.mNanosecondsPerDispatch = runDispatchBenchmark(executable);
+  }
+
+  if (
+    measureDepth &&
+    result.mCompileSeconds <= MAX_DEPTH_SEARCH_COMPILE_SECONDS)
+  {
+    result.mMinTemplateDepth = findMinTemplateDepth(combination);
+  }
+
+  std::remove(objectFile.c_str());
+  std::remove(executable.c_str());
+
+  return result;
+}
+
+
+template <typename T>
+std::string toString(const std::optional<T>& value, const int precision = 0)
+{
+  if (!value)
+  {
+    return "-";
+  }
+
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(precision) << *value;
+  return stream.str();
+}
+
+
+void printHeader(const Options& options)
+{
+  if (options.mCsvOutput)
+  {
+    std::cout <<
+      "impl,alternatives,body_size,compile_s,object_bytes,"
+      "min_template_depth,dispatch_ns\n";
+    return;
+  }
+
+  std::cout << std::left
+    << std::setw(12) << "impl"
+    << std::setw(14) << "alternatives"
+    << std::setw(11) << "body size"
+    << std::setw(13) << "compile [s]"
+    << std::setw(15) << "object [KiB]"
+    << std::setw(11) << "min depth"
+    << "dispatch [ns]\n";
+}
+
+
+void printResult(
+  const Options& options,
+  const Combination& combination,
+  const std::optional<Result>& result)
+{
+  const auto& impl = combination.mImpl;
+
+  if (!result)
+  {
+    const auto separator = options.mCsvOutput ? "," : "  ";
+    std::cout << impl.mName << separator
+      << combination.mNumAlternatives << separator
+      << combination.mBodySize
+      << (options.mCsvOutput ? ",,,,\n" : "  failed\n");
+    return;
+  }
+
+  if (options.mCsvOutput)
+  {
+    std::cout << impl.mName << ','
+      << combination.mNumAlternatives << ','
+      << combination.mBodySize << ','
+      << result->mCompileSeconds << ','
+      << result->mObjectSize << ','
+      << toString(result->mMinTemplateDepth) << ','
+      << toString(result->mNanosecondsPerDispatch, 3) << '\n';
+    return;
+  }
+
+  std::cout << std::left << std::fixed
+    << std::setw(12) << impl.mName
+    << std::setw(14) << combination.mNumAlternatives
+    << std::setw(11) << combination.mBodySize
+    << std::setw(13) << std::setprecision(2) << result->mCompileSeconds
+    << std::setw(15) << std::setprecision(1)
+      << static_cast<double>(result->mObjectSize) / 1024.0
+    << std::setw(11) << toString(result->mMinTemplateDepth)
+    << toString(result->mNanosecondsPerDispatch, 3) << '\n';
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  const auto options = parseOptions(argc, argv);
+  if (!options)
+  {
+    return 1;
+  }
+
+  printHeader(*options);
+
+  for (const auto numAlternatives : options->mSizes)
+  {
+    for (const auto bodySize : options->mBodySizes)
+    {
+      for (const auto& impl : options->mImplementations)
+      {
+        const auto combination = Combination{impl, numAlternatives, bodySize};
+        const auto result = measure(combination, options->mMeasureDepth);
+        printResult(*options, combination, result);
+      }
+    }
+  }
+
+  return 0;
+}
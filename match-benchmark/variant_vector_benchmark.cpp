@@ -0,0 +1,311 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Compares a std::vector of variants against VariantVector, for a collection
+// which is heavily skewed towards one alternative (like the entity lists in
+// the state-machine example).
+//
+// Both containers hold the same randomly generated elements. Each pass
+// advances all particles by one step:
+//
+//   - mixed: match() on every element, the other alternatives are skipped
+//   - partitioned: match_each() over the particles only
+//
+// Afterwards, a fraction of the elements is erased and replaced, and all
+// handles are checked, to make sure that handles to erased elements are
+// reported as stale even though their slots have been reused.
+//
+// Usage:
+//   variant_vector_benchmark [--elements N] [--passes N]
+
+#include "match.hpp"
+#include "variant_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+
+using namespace variant_talk;
+
+namespace
+{
+
+struct Particle
+{
+  float mX;
+  float mY;
+  float mVelocityX;
+  float mVelocityY;
+};
+
+
+struct Spark
+{
+  float mX;
+  float mY;
+  int mRemainingFrames;
+};
+
+
+struct Emitter
+{
+  float mX;
+  float mY;
+  double mParticlesPerSecond;
+  std::uint64_t mNumEmitted;
+  char mName[32];
+};
+
+
+using Entity = std::variant<Particle, Spark, Emitter>;
+using Entities = VariantVector<Particle, Spark, Emitter>;
+
+
+// Percentages of sparks and emitters, the rest are particles
+constexpr auto SPARK_PERCENTAGE = 9u;
+constexpr auto EMITTER_PERCENTAGE = 1u;
+
+// Every n-th element is erased and replaced during the handle check
+constexpr std::size_t ERASE_INTERVAL = 10;
+
+// Relative. Both containers keep the particles in insertion order, so the
+// checksums are summed in the same order and should be identical.
+constexpr auto CHECKSUM_TOLERANCE = 1e-9;
+
+
+struct Options
+{
+  std::size_t mNumElements = 1'000'000;
+  int mNumPasses = 10;
+};
+
+
+// Throws std::invalid_argument or std::out_of_range for malformed numbers
+std::optional<Options> parseArguments(const int argc, char** argv)
+{
+  Options options;
+
+  for (auto i = 1; i + 1 < argc; i += 2)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string{argv[i + 1]};
+
+    if (arg == "--elements")
+    {
+      options.mNumElements = std::stoul(value);
+    }
+    else if (arg == "--passes")
+    {
+      options.mNumPasses = std::stoi(value);
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (argc % 2 == 0 || options.mNumElements == 0 || options.mNumPasses <= 0)
+  {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+
+std::optional<Options> parseOptions(const int argc, char** argv)
+{
+  try
+  {
+    return parseArguments(argc, argv);
+  }
+  catch (const std::logic_error&)
+  {
+    return std::nullopt;
+  }
+}
+
+
+Entity makeEntity(std::mt19937& generator)
+{
+  std::uniform_real_distribution<float> coordinate{-100.0f, 100.0f};
+  const auto x = coordinate(generator);
+  const auto y = coordinate(generator);
+
+  const auto kind = generator() % 100;
+  if (kind < EMITTER_PERCENTAGE)
+  {
+    return Emitter{x, y, 60.0, 0, "emitter"};
+  }
+  else if (kind < EMITTER_PERCENTAGE + SPARK_PERCENTAGE)
+  {
+    return Spark{x, y, 30};
+  }
+
+  return Particle{x, y, coordinate(generator), coordinate(generator)};
+}
+
+
+void advance(Particle& particle)
+{
+  particle.mX += particle.mVelocityX * 0.01f;
+  particle.mY += particle.mVelocityY * 0.01f;
+}
+
+
+template <typename Pass>
+double measureSeconds(const int numPasses, Pass&& pass)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < numPasses; ++i)
+  {
+    pass();
+  }
+
+  return std::chrono::duration<double>{
+    std::chrono::steady_clock::now() - start}.count();
+}
+
+
+// Returns the number of handles whose state doesn't match expectations
+std::size_t checkHandles(
+  Entities& entities,
+  const std::vector<Entities::Handle>& handles,
+  std::mt19937& generator)
+{
+  std::size_t numErased = 0;
+  for (auto i = std::size_t{0}; i < handles.size(); i += ERASE_INTERVAL)
+  {
+    entities.erase(handles[i]);
+    ++numErased;
+  }
+
+  // Fills the freed slots again
+  for (auto i = std::size_t{0}; i < numErased; ++i)
+  {
+    entities.push_back(makeEntity(generator));
+  }
+
+  std::size_t numMismatches = 0;
+  for (auto i = std::size_t{0}; i < handles.size(); ++i)
+  {
+    const auto shouldBeLive = i % ERASE_INTERVAL != 0;
+    if (entities.contains(handles[i]) != shouldBeLive)
+    {
+      ++numMismatches;
+    }
+  }
+
+  return numMismatches;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  const auto options = parseOptions(argc, argv);
+  if (!options)
+  {
+    std::cerr <<
+      "Usage: variant_vector_benchmark [--elements N] [--passes N]\n";
+    return 1;
+  }
+
+  std::mt19937 generator{0};
+
+  std::vector<Entity> mixed;
+  Entities partitioned;
+  std::vector<Entities::Handle> handles;
+  mixed.reserve(options->mNumElements);
+  handles.reserve(options->mNumElements);
+
+  for (auto i = std::size_t{0}; i < options->mNumElements; ++i)
+  {
+    mixed.push_back(makeEntity(generator));
+    handles.push_back(partitioned.push_back(mixed.back()));
+  }
+
+  const auto mixedSeconds = measureSeconds(options->mNumPasses, [&]()
+  {
+    for (auto& entity : mixed)
+    {
+      match(entity,
+        [](Particle& particle) { advance(particle); },
+        [](auto&) {});
+    }
+  });
+
+  const auto partitionedSeconds = measureSeconds(options->mNumPasses, [&]()
+  {
+    match_each(partitioned, [](Particle& particle) { advance(particle); });
+  });
+
+  // Both containers must end up with the same particle positions, also keeps
+  // the compiler from discarding the passes.
+  auto mixedSum = 0.0;
+  for (const auto& entity : mixed)
+  {
+    if (const auto pParticle = std::get_if<Particle>(&entity))
+    {
+      mixedSum += static_cast<double>(pParticle->mX + pParticle->mY);
+    }
+  }
+
+  auto partitionedSum = 0.0;
+  for (const auto& particle : partitioned.elements<Particle>())
+  {
+    partitionedSum += static_cast<double>(particle.mX + particle.mY);
+  }
+
+  const auto numElements = static_cast<double>(options->mNumElements);
+  const auto toNanoseconds = 1e9 / (numElements * options->mNumPasses);
+
+  std::cout << std::fixed << std::setprecision(3)
+    << "elements:           " << options->mNumElements << " ("
+    << partitioned.count<Particle>() << " particles)\n"
+    << "element size:       " << sizeof(Entity) << " bytes mixed, "
+    << sizeof(Particle) << " bytes per particle\n"
+    << "mixed:              " << mixedSeconds * toNanoseconds
+    << " ns/element\n"
+    << "partitioned:        " << partitionedSeconds * toNanoseconds
+    << " ns/element\n"
+    << "checksums:          " << mixedSum << ", " << partitionedSum << '\n';
+
+  const auto numMismatches = checkHandles(partitioned, handles, generator);
+  std::cout << "handle mismatches:  " << numMismatches << '\n';
+
+  const auto sumsMatch = std::abs(mixedSum - partitionedSum) <=
+    CHECKSUM_TOLERANCE * std::max(std::abs(mixedSum), 1.0);
+
+  return sumsMatch && numMismatches == 0 ? 0 : 1;
+}
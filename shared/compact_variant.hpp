@@ -0,0 +1,300 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "type_list.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+template <std::size_t NumAlternatives>
+using SmallestIndexType = std::conditional_t<
+  (NumAlternatives <= std::numeric_limits<std::uint8_t>::max() + 1u),
+  std::uint8_t,
+  std::conditional_t<
+    (NumAlternatives <= std::numeric_limits<std::uint16_t>::max() + 1u),
+    std::uint16_t,
+    std::uint32_t>>;
+
+
+// Uninitialized storage for a T, used to materialize an alternative from the
+// variant's byte buffer without requiring a default constructor.
+template <typename T>
+union UninitializedSlot
+{
+  UninitializedSlot() {}
+
+  T mValue;
+};
+
+} // namespace detail
+
+
+// Space-efficient replacement for std::variant, restricted to trivially
+// copyable alternatives.
+//
+// The discriminator is the smallest unsigned type which can represent all
+// alternative indices, and it is packed directly behind the bytes of the
+// largest alternative without any alignment padding. The variant itself thus
+// has an alignment of 1, and a size of the largest alternative plus
+// (usually) one byte. As an example, for a variant of two ints and a char, this
+// yields 9 bytes instead of 12.
+//
+// Because the storage is unaligned, alternatives are never accessed in place.
+// Visiting copies the active alternative into a properly aligned temporary,
+// and when visiting a non-const variant, the (possibly modified) temporary is
+// written back after the visitor returns. Visitors must therefore not return
+// references to the alternative, and must not assign to the variant they are
+// visiting.
+//
+// Works with match(), and can be used like a std::variant with the visit()
+// overloads below.
+template <typename... Ts>
+class compact_variant
+{
+  static_assert(sizeof...(Ts) > 0, "Need at least one alternative");
+  static_assert(
+    (std::is_trivially_copyable_v<Ts> && ...),
+    "compact_variant only supports trivially copyable alternatives");
+
+  using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+
+public:
+  using index_type = detail::SmallestIndexType<sizeof...(Ts)>;
+
+  static constexpr auto alternative_count = sizeof...(Ts);
+
+  template <typename T>
+  static constexpr auto index_of = detail::indexOf<T, Ts...>();
+
+  template <
+    typename F = First,
+    typename = std::enable_if_t<std::is_default_constructible_v<F>>>
+  compact_variant()
+  {
+    store(First{});
+  }
+
+  template <
+    typename T,
+    typename = std::enable_if_t<detail::isOneOf<std::decay_t<T>, Ts...>>>
+  compact_variant(T&& value)
+  {
+    store(static_cast<std::decay_t<T>>(std::forward<T>(value)));
+  }
+
+  template <typename T, typename... Args>
+  void emplace(Args&&... args)
+  {
+    store(T(std::forward<Args>(args)...));
+  }
+
+  std::size_t index() const
+  {
+    return mIndex;
+  }
+
+  template <typename T>
+  bool holds_alternative() const
+  {
+    return mIndex == index_of<T>;
+  }
+
+  // Returns a copy of the alternative T, which must be the active one.
+  template <typename T>
+  T get() const
+  {
+    assert(mIndex == index_of<T>);
+    return load<T>();
+  }
+
+  // Invokes the visitor with the alternative T, which must be the active one.
+  template <typename T, typename Visitor>
+  decltype(auto) visit_as(Visitor&& visitor)
+  {
+    using Result = std::invoke_result_t<Visitor&, T&>;
+    static_assert(
+      !std::is_reference_v<Result>,
+      "Visitors of compact_variant must return by value");
+
+    assert(mIndex == index_of<T>);
+    return invokeWith<T, Result>(visitor, *this);
+  }
+
+  template <typename T, typename Visitor>
+  decltype(auto) visit_as(Visitor&& visitor) const
+  {
+    using Result = std::invoke_result_t<Visitor&, const T&>;
+    static_assert(
+      !std::is_reference_v<Result>,
+      "Visitors of compact_variant must return by value");
+
+    assert(mIndex == index_of<T>);
+    return invokeWith<T, Result>(visitor, *this);
+  }
+
+  template <typename Visitor>
+  friend decltype(auto) visit(Visitor&& visitor, compact_variant& variant)
+  {
+    return variant.dispatch(std::forward<Visitor>(visitor));
+  }
+
+  template <typename Visitor>
+  friend decltype(auto) visit(Visitor&& visitor, const compact_variant& variant)
+  {
+    return variant.dispatch(std::forward<Visitor>(visitor));
+  }
+
+  template <typename Visitor>
+  friend decltype(auto) visit(Visitor&& visitor, compact_variant&& variant)
+  {
+    return variant.dispatch(std::forward<Visitor>(visitor));
+  }
+
+private:
+  static constexpr auto STORAGE_SIZE = std::max({sizeof(Ts)...});
+
+  template <typename T>
+  void store(const T& value)
+  {
+    static_assert(detail::isOneOf<T, Ts...>, "Type is not an alternative");
+
+    std::memcpy(mStorage, &value, sizeof(T));
+    mIndex = static_cast<index_type>(index_of<T>);
+  }
+
+  template <typename T>
+  T load() const
+  {
+    detail::UninitializedSlot<T> slot;
+    std::memcpy(&slot.mValue, mStorage, sizeof(T));
+    return slot.mValue;
+  }
+
+  template <typename T, typename Result, typename Visitor, typename Self>
+  static Result invokeWith(Visitor& visitor, Self& self)
+  {
+    if constexpr (std::is_const_v<Self>)
+    {
+      const T value = self.template load<T>();
+      return std::invoke(visitor, value);
+    }
+    else
+    {
+      struct WriteBack
+      {
+        ~WriteBack()
+        {
+          mSelf.store(mValue);
+        }
+
+        Self& mSelf;
+        T mValue;
+      };
+
+      WriteBack alternative{self, self.template load<T>()};
+      return std::invoke(visitor, alternative.mValue);
+    }
+  }
+
+  template <typename Visitor>
+  decltype(auto) dispatch(Visitor&& visitor)
+  {
+    return dispatchImpl(visitor, *this);
+  }
+
+  template <typename Visitor>
+  decltype(auto) dispatch(Visitor&& visitor) const
+  {
+    return dispatchImpl(visitor, *this);
+  }
+
+  template <typename Visitor, typename Self>
+  static decltype(auto) dispatchImpl(Visitor& visitor, Self& self)
+  {
+    using FirstArg = std::conditional_t<
+      std::is_const_v<Self>, const First&, First&>;
+    using Result = std::invoke_result_t<Visitor&, FirstArg>;
+    static_assert(
+      !std::is_reference_v<Result>,
+      "Visitors of compact_variant must return by value");
+
+    if constexpr (sizeof...(Ts) <= MAX_BRANCHING_DISPATCH_ALTERNATIVES)
+    {
+      return dispatchByBranching<0, Result>(visitor, self);
+    }
+    else
+    {
+      // Must be static, otherwise the table is rebuilt on the stack on every
+      // call
+      using Thunk = Result (*)(Visitor&, Self&);
+      static constexpr Thunk thunks[] = {
+        &invokeWith<Ts, Result, Visitor, Self>...};
+
+      return thunks[self.mIndex](visitor, self);
+    }
+  }
+
+  // For few alternatives, a chain of comparisons (which the compiler is free
+  // to turn into a jump table) beats an indirect call, as the visitor can be
+  // inlined.
+  static constexpr auto MAX_BRANCHING_DISPATCH_ALTERNATIVES = std::size_t{8};
+
+  template <std::size_t I, typename Result, typename Visitor, typename Self>
+  static Result dispatchByBranching(Visitor& visitor, Self& self)
+  {
+    using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    if constexpr (I + 1 == sizeof...(Ts))
+    {
+      return invokeWith<T, Result>(visitor, self);
+    }
+    else
+    {
+      if (self.mIndex == I)
+      {
+        return invokeWith<T, Result>(visitor, self);
+      }
+
+      return dispatchByBranching<I + 1, Result>(visitor, self);
+    }
+  }
+
+  unsigned char mStorage[STORAGE_SIZE] = {};
+  index_type mIndex;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,228 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+[[noreturn]] void fail(const std::string& path, const char* what)
+{
+  throw std::runtime_error{"Cannot map file '" + path + "': " + what};
+}
+
+} // namespace
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+  mFileHandle = CreateFileA(
+    path.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_FLAG_SEQUENTIAL_SCAN,
+    nullptr);
+  if (mFileHandle == INVALID_HANDLE_VALUE)
+  {
+    mFileHandle = nullptr;
+    fail(path, "open failed");
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(mFileHandle, &fileSize))
+  {
+    unmap();
+    fail(path, "querying size failed");
+  }
+
+  mSize = static_cast<std::size_t>(fileSize.QuadPart);
+  if (mSize == 0)
+  {
+    return;
+  }
+
+  mMappingHandle =
+    CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mMappingHandle)
+  {
+    unmap();
+    fail(path, "creating mapping failed");
+  }
+
+  mpData = static_cast<const unsigned char*>(
+    MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!mpData)
+  {
+    unmap();
+    fail(path, "mapping view failed");
+  }
+}
+
+
+void MappedFile::adviseSequentialAccess() const
+{
+  // Already requested via FILE_FLAG_SEQUENTIAL_SCAN
+}
+
+
+void MappedFile::unmap()
+{
+  if (mpData)
+  {
+    UnmapViewOfFile(mpData);
+  }
+
+  if (mMappingHandle)
+  {
+    CloseHandle(mMappingHandle);
+  }
+
+  if (mFileHandle)
+  {
+    CloseHandle(mFileHandle);
+  }
+
+  mpData = nullptr;
+  mSize = 0;
+  mMappingHandle = nullptr;
+  mFileHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    fail(path, "open failed");
+  }
+
+  struct stat fileStatus;
+  if (::fstat(fd, &fileStatus) == -1)
+  {
+    ::close(fd);
+    fail(path, "querying size failed");
+  }
+
+  mSize = static_cast<std::size_t>(fileStatus.st_size);
+  if (mSize == 0)
+  {
+    ::close(fd);
+    return;
+  }
+
+  auto pMapping = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // The mapping stays valid after closing the descriptor
+  ::close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    mSize = 0;
+    fail(path, "mmap failed");
+  }
+
+  mpData = static_cast<const unsigned char*>(pMapping);
+}
+
+
+void MappedFile::adviseSequentialAccess() const
+{
+  if (mpData)
+  {
+    ::madvise(
+      const_cast<unsigned char*>(mpData), mSize, MADV_SEQUENTIAL);
+  }
+}
+
+
+void MappedFile::unmap()
+{
+  if (mpData)
+  {
+    ::munmap(const_cast<unsigned char*>(mpData), mSize);
+  }
+
+  mpData = nullptr;
+  mSize = 0;
+}
+
+#endif
+
+
+MappedFile::~MappedFile()
+{
+  unmap();
+}
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : mpData(std::exchange(other.mpData, nullptr))
+  , mSize(std::exchange(other.mSize, 0))
+#ifdef _WIN32
+  , mFileHandle(std::exchange(other.mFileHandle, nullptr))
+  , mMappingHandle(std::exchange(other.mMappingHandle, nullptr))
+#endif
+{
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    unmap();
+
+    mpData = std::exchange(other.mpData, nullptr);
+    mSize = std::exchange(other.mSize, 0);
+#ifdef _WIN32
+    mFileHandle = std::exchange(other.mFileHandle, nullptr);
+    mMappingHandle = std::exchange(other.mMappingHandle, nullptr);
+#endif
+  }
+
+  return *this;
+}
+
+} // namespace variant_talk
@@ -0,0 +1,73 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+namespace variant_talk
+{
+
+// Read-only memory mapping of an entire file.
+//
+// The constructor throws std::runtime_error if the file can't be opened or
+// mapped. An empty file yields an empty mapping with a null data() pointer.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data() const
+  {
+    return mpData;
+  }
+
+  std::size_t size() const
+  {
+    return mSize;
+  }
+
+  // Hint to the OS that the mapping will be read front to back, so that it
+  // can read ahead aggressively. No-op on platforms without such a hint.
+  void adviseSequentialAccess() const;
+
+private:
+  void unmap();
+
+  const unsigned char* mpData = nullptr;
+  std::size_t mSize = 0;
+
+#ifdef _WIN32
+  void* mFileHandle = nullptr;
+  void* mMappingHandle = nullptr;
+#endif
+};
+
+} // namespace variant_talk
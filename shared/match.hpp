@@ -21,9 +21,26 @@
 
 #pragma once
 
+#include "type_list.hpp"
+
+#include <type_traits>
 #include <utility>
 #include <variant>
 
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+#include "match_statistics.hpp"
+
+#include <tuple>
+#include <typeinfo>
+#endif
+
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VARIANT_TALK_LIKELY(condition) __builtin_expect(!!(condition), 1)
+#else
+#define VARIANT_TALK_LIKELY(condition) (condition)
+#endif
+
 
 namespace variant_talk
 {
@@ -40,15 +57,101 @@ struct overloaded : Ts...
 template<class... Ts>
 overloaded(Ts...) -> overloaded<Ts...>;
 
+
+template <typename T, typename... Ts>
+bool holdsAlternative(const std::variant<Ts...>& variant)
+{
+  return std::holds_alternative<T>(variant);
+}
+
+
+template <typename T, typename Variant>
+bool holdsAlternative(const Variant& variant)
+{
+  return variant.template holds_alternative<T>();
+}
+
+
+template <typename T, typename Visitor, typename... Ts>
+decltype(auto) visitAs(Visitor& visitor, std::variant<Ts...>& variant)
+{
+  return visitor(*std::get_if<T>(&variant));
+}
+
+
+template <typename T, typename Visitor, typename... Ts>
+decltype(auto) visitAs(Visitor& visitor, const std::variant<Ts...>& variant)
+{
+  return visitor(*std::get_if<T>(&variant));
+}
+
+
+template <typename T, typename Visitor, typename Variant>
+decltype(auto) visitAs(Visitor& visitor, Variant& variant)
+{
+  return variant.template visit_as<T>(visitor);
+}
+
+
+template <typename Variant>
+struct AlternativeIndex;
+
+template <template <typename...> class Variant, typename... Ts>
+struct AlternativeIndex<Variant<Ts...>>
+{
+  template <typename T>
+  static constexpr auto of = indexOf<T, Ts...>();
+};
+
 } // namespace detail
 
 
+// Works with std::variant, as well as with any other variant type that provides
+// a visit() function which can be found via ADL (e.g. compact_variant).
 template <typename Variant, typename... Matchers>
 auto match(Variant&& variant, Matchers&&... matchers)
 {
-  return std::visit(
+  using std::visit;
+
+  return visit(
     detail::overloaded{std::forward<Matchers>(matchers)...},
     std::forward<Variant>(variant));
 }
 
+
+// Like match(), but optimized for the case that the variant almost always
+// holds the alternative Likely. That alternative is tested for first with a
+// branch marked as likely taken, and its matcher is invoked directly (and can
+// be inlined). All other alternatives go through the regular dispatch.
+//
+// When building with VARIANT_TALK_MATCH_STATISTICS defined, each call site
+// counts the alternatives it actually sees. Use printMatchStatistics() to
+// check if the expectation holds.
+template <typename Likely, typename Variant, typename... Matchers>
+auto match_likely(Variant&& variant, Matchers&&... matchers)
+{
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  using VariantType = std::decay_t<Variant>;
+  using FirstMatcher =
+    std::decay_t<std::tuple_element_t<0, std::tuple<Matchers...>>>;
+
+  static detail::MatchSiteStatistics statistics{
+    detail::callSiteName(typeid(FirstMatcher)),
+    detail::AlternativeNames<VariantType>::get(),
+    detail::AlternativeIndex<VariantType>::template of<Likely>};
+  statistics.record(variant.index());
+#endif
+
+  auto visitor = detail::overloaded{std::forward<Matchers>(matchers)...};
+
+  if (VARIANT_TALK_LIKELY(detail::holdsAlternative<Likely>(variant)))
+  {
+    return detail::visitAs<Likely>(visitor, variant);
+  }
+
+  using std::visit;
+
+  return visit(visitor, std::forward<Variant>(variant));
+}
+
 } // namespace variant_talk
@@ -0,0 +1,215 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+inline std::string demangledName(const std::type_info& type)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  auto status = 0;
+  const auto pDemangled = std::unique_ptr<char, void (*)(void*)>{
+    abi::__cxa_demangle(type.name(), nullptr, nullptr, &status),
+    std::free};
+
+  if (status == 0 && pDemangled)
+  {
+    return pDemangled.get();
+  }
+#endif
+
+  return type.name();
+}
+
+
+// Lambda types are named after the function which contains them, e.g.
+// "Game::update(double)::{lambda(...)#1}". This reduces such a name to the
+// containing function, which is what identifies the call site.
+inline std::string callSiteName(const std::type_info& matcherType)
+{
+  auto name = demangledName(matcherType);
+
+  const auto lambdaStart = name.find("::{lambda");
+  if (lambdaStart != std::string::npos)
+  {
+    name.erase(lambdaStart);
+  }
+
+  return name;
+}
+
+
+class MatchSiteStatistics
+{
+public:
+  MatchSiteStatistics(
+    std::string siteName,
+    std::vector<std::string> alternativeNames,
+    std::size_t expectedIndex);
+
+  // Ignores indices which don't name an alternative, like the variant_npos
+  // of a std::variant which is valueless by exception. Visiting such a
+  // variant throws anyway.
+  void record(const std::size_t index)
+  {
+    if (index < mAlternativeNames.size())
+    {
+      mCounts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void print(std::ostream& stream) const;
+
+private:
+  std::string mSiteName;
+  std::vector<std::string> mAlternativeNames;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> mCounts;
+  std::size_t mExpectedIndex;
+};
+
+
+struct MatchStatisticsRegistry
+{
+  std::mutex mMutex;
+  std::vector<const MatchSiteStatistics*> mSites;
+};
+
+
+inline MatchStatisticsRegistry& matchStatisticsRegistry()
+{
+  static MatchStatisticsRegistry registry;
+  return registry;
+}
+
+
+inline MatchSiteStatistics::MatchSiteStatistics(
+  std::string siteName,
+  std::vector<std::string> alternativeNames,
+  const std::size_t expectedIndex
+)
+  : mSiteName(std::move(siteName))
+  , mAlternativeNames(std::move(alternativeNames))
+  , mCounts(new std::atomic<std::uint64_t>[mAlternativeNames.size()]{})
+  , mExpectedIndex(expectedIndex)
+{
+  auto& registry = matchStatisticsRegistry();
+
+  std::lock_guard<std::mutex> lock{registry.mMutex};
+  registry.mSites.push_back(this);
+}
+
+
+inline void MatchSiteStatistics::print(std::ostream& stream) const
+{
+  std::vector<std::uint64_t> counts;
+  for (auto i = 0u; i < mAlternativeNames.size(); ++i)
+  {
+    counts.push_back(mCounts[i].load(std::memory_order_relaxed));
+  }
+
+  const auto iDominant = std::max_element(counts.begin(), counts.end());
+  const auto dominantIndex =
+    static_cast<std::size_t>(std::distance(counts.begin(), iDominant));
+
+  auto total = std::uint64_t{0};
+  for (const auto count : counts)
+  {
+    total += count;
+  }
+
+  stream << mSiteName << " (" << total << " matches)";
+  if (total > 0 && dominantIndex != mExpectedIndex)
+  {
+    stream << " - expected alternative is NOT the dominant one";
+  }
+  stream << '\n';
+
+  for (auto i = 0u; i < counts.size(); ++i)
+  {
+    const auto percentage = total > 0
+      ? 100.0 * static_cast<double>(counts[i]) / static_cast<double>(total)
+      : 0.0;
+
+    stream << (i == mExpectedIndex ? "  * " : "    ")
+      << mAlternativeNames[i] << ": " << counts[i]
+      << " (" << percentage << "%)\n";
+  }
+}
+
+
+template <typename Variant>
+struct AlternativeNames;
+
+template <template <typename...> class Variant, typename... Ts>
+struct AlternativeNames<Variant<Ts...>>
+{
+  static std::vector<std::string> get()
+  {
+    return {demangledName(typeid(Ts))...};
+  }
+};
+
+} // namespace detail
+
+
+// Writes the alternative counts recorded by all match_likely() call sites
+// executed so far. The expected alternative of each site is marked with '*'.
+inline void printMatchStatistics(std::ostream& stream)
+{
+  auto& registry = detail::matchStatisticsRegistry();
+
+  std::lock_guard<std::mutex> lock{registry.mMutex};
+
+  if (registry.mSites.empty())
+  {
+    return;
+  }
+
+  stream << "\nmatch_likely statistics:\n";
+  for (const auto pSite : registry.mSites)
+  {
+    pSite->print(stream);
+  }
+}
+
+} // namespace variant_talk
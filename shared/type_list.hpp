@@ -0,0 +1,55 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+
+namespace variant_talk
+{
+
+namespace detail
+{
+
+template <typename T, typename... Ts>
+constexpr bool isOneOf = (std::is_same_v<T, Ts> || ...);
+
+
+// Position of T in the list Ts. Yields sizeof...(Ts) if T is not part of it.
+template <typename T, typename... Ts>
+constexpr std::size_t indexOf()
+{
+  constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+
+  std::size_t index = 0;
+  while (index < sizeof...(Ts) && !matches[index])
+  {
+    ++index;
+  }
+
+  return index;
+}
+
+} // namespace detail
+
+} // namespace variant_talk
@@ -0,0 +1,481 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "match.hpp"
+#include "type_list.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+enum class InsertionOrder
+{
+  Untracked,
+  Tracked
+};
+
+
+// Container for values of type std::variant<Ts...>, which stores each
+// alternative in its own contiguous array.
+//
+// Elements don't pay for the size of the largest alternative, and all elements
+// of one type can be processed in a single loop without branching on the type
+// (see match_each). Elements are addressed via handles, which stay valid until
+// the element they refer to is erased. Erasing an element moves the last
+// element of the same type into the gap, so the order within one type is not
+// preserved. If the original insertion order is needed, it can be tracked by
+// passing InsertionOrder::Tracked (see match_in_order).
+//
+// Slots are reused after an erase, so each handle also carries the slot's
+// generation at the time of insertion. A stale handle doesn't match the
+// slot's current generation: contains() returns false for it, and accessing
+// an element through it triggers an assertion.
+template <typename... Ts>
+class VariantVector
+{
+public:
+  using value_type = std::variant<Ts...>;
+
+  struct Handle
+  {
+    std::uint32_t typeIndex;
+    std::uint32_t slot;
+    std::uint32_t generation;
+
+    friend bool operator==(const Handle& lhs, const Handle& rhs)
+    {
+      return
+        lhs.typeIndex == rhs.typeIndex &&
+        lhs.slot == rhs.slot &&
+        lhs.generation == rhs.generation;
+    }
+  };
+
+  explicit VariantVector(InsertionOrder order = InsertionOrder::Untracked)
+    : mTrackInsertionOrder(order == InsertionOrder::Tracked)
+  {
+  }
+
+  template <typename T, typename... Args>
+  Handle emplace_back(Args&&... args);
+
+  template <
+    typename T,
+    typename = std::enable_if_t<detail::isOneOf<std::decay_t<T>, Ts...>>>
+  Handle push_back(T&& value)
+  {
+    return emplace_back<std::decay_t<T>>(std::forward<T>(value));
+  }
+
+  Handle push_back(const value_type& value)
+  {
+    return std::visit(
+      [this](const auto& alternative) { return push_back(alternative); },
+      value);
+  }
+
+  void erase(Handle handle);
+  void clear();
+
+  template <typename T>
+  void reserve(std::size_t capacity);
+
+  // False for handles whose element has been erased (or cleared)
+  bool contains(Handle handle) const;
+
+  template <typename T>
+  T& get(Handle handle);
+
+  template <typename T>
+  const T& get(Handle handle) const;
+
+  // Invokes the visitor with the element referred to by the handle
+  template <typename Visitor>
+  void visit(Handle handle, Visitor&& visitor);
+
+  template <typename Visitor>
+  void visit(Handle handle, Visitor&& visitor) const;
+
+  // All elements of type T, in no particular order
+  template <typename T>
+  const std::vector<T>& elements() const;
+
+  template <typename T>
+  std::size_t count() const;
+
+  std::size_t size() const;
+  bool empty() const;
+
+  bool tracksInsertionOrder() const;
+  const std::vector<Handle>& insertionOrder() const;
+
+  template <typename Container, typename... Matchers>
+  friend void match_each(Container&& container, Matchers&&... matchers);
+
+private:
+  static constexpr auto FREE_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+  template <typename T>
+  struct Partition
+  {
+    std::vector<T> mElements;
+    std::vector<std::uint32_t> mSlotOfElement;
+    std::vector<std::uint32_t> mElementOfSlot;
+    std::vector<std::uint32_t> mGenerationOfSlot;
+    std::vector<std::uint32_t> mFreeSlots;
+  };
+
+  template <typename T>
+  static constexpr std::uint32_t indexOfType()
+  {
+    static_assert(detail::isOneOf<T, Ts...>, "Type is not an alternative");
+    return static_cast<std::uint32_t>(detail::indexOf<T, Ts...>());
+  }
+
+  template <typename T>
+  Partition<T>& partition()
+  {
+    return std::get<Partition<T>>(mPartitions);
+  }
+
+  template <typename T>
+  const Partition<T>& partition() const
+  {
+    return std::get<Partition<T>>(mPartitions);
+  }
+
+  template <typename T>
+  static bool isLiveIn(const Partition<T>& partition, Handle handle);
+
+  template <typename T>
+  void eraseFrom(Partition<T>& partition, std::uint32_t slot);
+
+  std::tuple<Partition<Ts>...> mPartitions;
+  std::vector<Handle> mInsertionOrder;
+  bool mTrackInsertionOrder;
+};
+
+
+template <typename... Ts>
+template <typename T, typename... Args>
+auto VariantVector<Ts...>::emplace_back(Args&&... args) -> Handle
+{
+  auto& part = partition<T>();
+
+  const auto elementIndex = static_cast<std::uint32_t>(part.mElements.size());
+  part.mElements.emplace_back(std::forward<Args>(args)...);
+
+  std::uint32_t slot;
+  if (!part.mFreeSlots.empty())
+  {
+    slot = part.mFreeSlots.back();
+    part.mFreeSlots.pop_back();
+    part.mElementOfSlot[slot] = elementIndex;
+  }
+  else
+  {
+    slot = static_cast<std::uint32_t>(part.mElementOfSlot.size());
+    part.mElementOfSlot.push_back(elementIndex);
+    part.mGenerationOfSlot.push_back(0);
+  }
+
+  part.mSlotOfElement.push_back(slot);
+
+  const auto handle =
+    Handle{indexOfType<T>(), slot, part.mGenerationOfSlot[slot]};
+  if (mTrackInsertionOrder)
+  {
+    mInsertionOrder.push_back(handle);
+  }
+
+  return handle;
+}
+
+
+template <typename... Ts>
+void VariantVector<Ts...>::erase(const Handle handle)
+{
+  assert(contains(handle));
+
+  // Expands to a chain of comparisons, only the partition matching the
+  // handle's type index is touched.
+  ((handle.typeIndex == indexOfType<Ts>()
+    ? (eraseFrom(partition<Ts>(), handle.slot), true)
+    : false) || ...);
+
+  if (mTrackInsertionOrder)
+  {
+    // Linear, but only paid when the insertion order is tracked.
+    mInsertionOrder.erase(std::find(
+      mInsertionOrder.begin(), mInsertionOrder.end(), handle));
+  }
+}
+
+
+template <typename... Ts>
+template <typename T>
+void VariantVector<Ts...>::eraseFrom(
+  Partition<T>& part,
+  const std::uint32_t slot)
+{
+  assert(slot < part.mElementOfSlot.size());
+
+  const auto elementIndex = part.mElementOfSlot[slot];
+  const auto lastIndex = static_cast<std::uint32_t>(part.mElements.size() - 1);
+  assert(elementIndex != FREE_SLOT);
+
+  if (elementIndex != lastIndex)
+  {
+    // Swap-remove: The last element fills the gap, and its slot is updated to
+    // point to its new position.
+    part.mElements[elementIndex] = std::move(part.mElements[lastIndex]);
+
+    const auto movedSlot = part.mSlotOfElement[lastIndex];
+    part.mSlotOfElement[elementIndex] = movedSlot;
+    part.mElementOfSlot[movedSlot] = elementIndex;
+  }
+
+  part.mElements.pop_back();
+  part.mSlotOfElement.pop_back();
+  part.mElementOfSlot[slot] = FREE_SLOT;
+  ++part.mGenerationOfSlot[slot];
+  part.mFreeSlots.push_back(slot);
+}
+
+
+template <typename... Ts>
+void VariantVector<Ts...>::clear()
+{
+  // Slots and their generations are kept, so that handles from before the
+  // clear() are still recognized as stale afterwards.
+  auto clearPartition = [](auto& part)
+  {
+    for (const auto slot : part.mSlotOfElement)
+    {
+      part.mElementOfSlot[slot] = FREE_SLOT;
+      ++part.mGenerationOfSlot[slot];
+      part.mFreeSlots.push_back(slot);
+    }
+
+    part.mElements.clear();
+    part.mSlotOfElement.clear();
+  };
+
+  std::apply(
+    [&](auto&... partitions)
+    {
+      (clearPartition(partitions), ...);
+    },
+    mPartitions);
+
+  mInsertionOrder.clear();
+}
+
+
+template <typename... Ts>
+template <typename T>
+void VariantVector<Ts...>::reserve(const std::size_t capacity)
+{
+  auto& part = partition<T>();
+  part.mElements.reserve(capacity);
+  part.mSlotOfElement.reserve(capacity);
+  part.mElementOfSlot.reserve(capacity);
+  part.mGenerationOfSlot.reserve(capacity);
+}
+
+
+template <typename... Ts>
+template <typename T>
+bool VariantVector<Ts...>::isLiveIn(
+  const Partition<T>& part,
+  const Handle handle)
+{
+  return
+    handle.slot < part.mElementOfSlot.size() &&
+    part.mGenerationOfSlot[handle.slot] == handle.generation &&
+    part.mElementOfSlot[handle.slot] != FREE_SLOT;
+}
+
+
+template <typename... Ts>
+bool VariantVector<Ts...>::contains(const Handle handle) const
+{
+  return ((handle.typeIndex == indexOfType<Ts>() &&
+    isLiveIn(partition<Ts>(), handle)) || ...);
+}
+
+
+template <typename... Ts>
+template <typename T>
+T& VariantVector<Ts...>::get(const Handle handle)
+{
+  assert(handle.typeIndex == indexOfType<T>());
+
+  auto& part = partition<T>();
+  assert(isLiveIn(part, handle));
+  return part.mElements[part.mElementOfSlot[handle.slot]];
+}
+
+
+template <typename... Ts>
+template <typename T>
+const T& VariantVector<Ts...>::get(const Handle handle) const
+{
+  assert(handle.typeIndex == indexOfType<T>());
+
+  const auto& part = partition<T>();
+  assert(isLiveIn(part, handle));
+  return part.mElements[part.mElementOfSlot[handle.slot]];
+}
+
+
+template <typename... Ts>
+template <typename Visitor>
+void VariantVector<Ts...>::visit(const Handle handle, Visitor&& visitor)
+{
+  ((handle.typeIndex == indexOfType<Ts>()
+    ? (visitor(get<Ts>(handle)), true)
+    : false) || ...);
+}
+
+
+template <typename... Ts>
+template <typename Visitor>
+void VariantVector<Ts...>::visit(const Handle handle, Visitor&& visitor) const
+{
+  ((handle.typeIndex == indexOfType<Ts>()
+    ? (visitor(get<Ts>(handle)), true)
+    : false) || ...);
+}
+
+
+template <typename... Ts>
+template <typename T>
+const std::vector<T>& VariantVector<Ts...>::elements() const
+{
+  return partition<T>().mElements;
+}
+
+
+template <typename... Ts>
+template <typename T>
+std::size_t VariantVector<Ts...>::count() const
+{
+  return partition<T>().mElements.size();
+}
+
+
+template <typename... Ts>
+std::size_t VariantVector<Ts...>::size() const
+{
+  return (count<Ts>() + ...);
+}
+
+
+template <typename... Ts>
+bool VariantVector<Ts...>::empty() const
+{
+  return size() == 0;
+}
+
+
+template <typename... Ts>
+bool VariantVector<Ts...>::tracksInsertionOrder() const
+{
+  return mTrackInsertionOrder;
+}
+
+
+template <typename... Ts>
+auto VariantVector<Ts...>::insertionOrder() const -> const std::vector<Handle>&
+{
+  return mInsertionOrder;
+}
+
+
+// Visits all elements of a VariantVector, one type at a time.
+//
+// For each alternative which can be handled by the given matchers, all
+// elements of that type are visited in a single loop. Alternatives which none
+// of the matchers accept are skipped entirely, so passing a single matcher
+// visits only the elements of that one type:
+//
+//   match_each(entities, [](Projectile& projectile) { ... });
+//
+// The matchers must not add or erase elements while being invoked.
+template <typename Container, typename... Matchers>
+void match_each(Container&& container, Matchers&&... matchers)
+{
+  auto visitor = detail::overloaded{std::forward<Matchers>(matchers)...};
+
+  std::apply(
+    [&](auto&... partitions)
+    {
+      auto visitPartition = [&](auto& partition)
+      {
+        using Element = decltype(partition.mElements[0]);
+
+        if constexpr (std::is_invocable_v<decltype(visitor)&, Element>)
+        {
+          for (auto& element : partition.mElements)
+          {
+            visitor(element);
+          }
+        }
+      };
+
+      (visitPartition(partitions), ...);
+    },
+    container.mPartitions);
+}
+
+
+// Visits all elements of a VariantVector in the order they were inserted.
+//
+// Requires InsertionOrder::Tracked. Like match(), the matchers must handle all
+// alternatives. This jumps between the per-type arrays, prefer match_each
+// when the order doesn't matter.
+template <typename Container, typename... Matchers>
+void match_in_order(Container&& container, Matchers&&... matchers)
+{
+  assert(container.tracksInsertionOrder());
+
+  auto visitor = detail::overloaded{std::forward<Matchers>(matchers)...};
+
+  for (const auto& handle : container.insertionOrder())
+  {
+    container.visit(handle, visitor);
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,155 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "asset_loader.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+
+namespace variant_talk
+{
+
+AssetLoader::~AssetLoader()
+{
+  // Jobs which are already running are completed, the rest is skipped
+  mIsStopping = true;
+
+  for (auto& worker : mWorkers)
+  {
+    worker.join();
+  }
+}
+
+
+void AssetLoader::loadImage(std::string path, ImageCallback onLoaded)
+{
+  assert(mWorkers.empty());
+
+  auto pImage = std::make_shared<sf::Image>();
+  mJobs.push_back(Job{
+    [pImage, path = std::move(path)]()
+    {
+      pImage->loadFromFile(path);
+    },
+
+    [pImage, onLoaded = std::move(onLoaded)]()
+    {
+      onLoaded(*pImage);
+    }});
+}
+
+
+void AssetLoader::loadFile(std::string path, FileCallback onLoaded)
+{
+  assert(mWorkers.empty());
+
+  auto pContents = std::make_shared<std::vector<char>>();
+  mJobs.push_back(Job{
+    [pContents, path = std::move(path)]()
+    {
+      std::ifstream file{path, std::ios::binary};
+      pContents->assign(
+        std::istreambuf_iterator<char>{file},
+        std::istreambuf_iterator<char>{});
+    },
+
+    [pContents, onLoaded = std::move(onLoaded)]()
+    {
+      onLoaded(*pContents);
+    }});
+}
+
+
+void AssetLoader::start()
+{
+  const auto numThreads = std::clamp(
+    std::size_t{std::thread::hardware_concurrency()},
+    std::size_t{1},
+    std::max(mJobs.size(), std::size_t{1}));
+
+  for (auto i = std::size_t{0}; i < numThreads; ++i)
+  {
+    mWorkers.emplace_back([this]() { runWorker(); });
+  }
+}
+
+
+void AssetLoader::poll()
+{
+  {
+    std::lock_guard<std::mutex> lock{mLoadedJobsMutex};
+    std::swap(mLoadedJobs, mJobsToFinish);
+  }
+
+  for (const auto index : mJobsToFinish)
+  {
+    mJobs[index].mFinish();
+
+    // Releases the decoded data
+    mJobs[index] = Job{};
+  }
+
+  mNumFinishedJobs += mJobsToFinish.size();
+  mJobsToFinish.clear();
+}
+
+
+bool AssetLoader::isDone() const
+{
+  return mNumFinishedJobs == mJobs.size();
+}
+
+
+std::size_t AssetLoader::numAssets() const
+{
+  return mJobs.size();
+}
+
+
+std::size_t AssetLoader::numFinishedAssets() const
+{
+  return mNumFinishedJobs;
+}
+
+
+void AssetLoader::runWorker()
+{
+  while (!mIsStopping)
+  {
+    const auto index = mNextJob++;
+    if (index >= mJobs.size())
+    {
+      return;
+    }
+
+    mJobs[index].mLoad();
+
+    std::lock_guard<std::mutex> lock{mLoadedJobsMutex};
+    mLoadedJobs.push_back(index);
+  }
+}
+
+} // namespace variant_talk
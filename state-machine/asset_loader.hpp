@@ -0,0 +1,99 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Loads assets in the background, so that the game can show something right
+// away instead of waiting for all files to be decoded.
+//
+// Reading and decoding happens on a pool of worker threads. What to do with
+// the result (e.g. uploading an image to a texture) is up to the callback
+// given for each asset, which runs on the thread calling poll(). That's
+// normally the render thread, since OpenGL resources must be created there.
+//
+// Usage: Request all assets, then call start() once, followed by poll() every
+// frame until isDone() returns true.
+class AssetLoader
+{
+public:
+  using ImageCallback = std::function<void(sf::Image&)>;
+  using FileCallback = std::function<void(std::vector<char>&)>;
+
+  AssetLoader() = default;
+  ~AssetLoader();
+
+  AssetLoader(const AssetLoader&) = delete;
+  AssetLoader& operator=(const AssetLoader&) = delete;
+
+  // Decodes the given image file. An image which fails to load is passed on
+  // empty.
+  void loadImage(std::string path, ImageCallback onLoaded);
+
+  // Reads the entire contents of the given file, without interpreting them.
+  // A file which can't be read results in an empty buffer.
+  void loadFile(std::string path, FileCallback onLoaded);
+
+  void start();
+
+  // Invokes the callbacks of all assets which have finished loading since
+  // the last call.
+  void poll();
+
+  bool isDone() const;
+
+  std::size_t numAssets() const;
+  std::size_t numFinishedAssets() const;
+
+private:
+  struct Job
+  {
+    std::function<void()> mLoad; // runs on a worker thread
+    std::function<void()> mFinish; // runs in poll()
+  };
+
+  void runWorker();
+
+  std::vector<Job> mJobs;
+  std::vector<std::thread> mWorkers;
+  std::atomic<std::size_t> mNextJob{0};
+  std::atomic<bool> mIsStopping{false};
+
+  std::mutex mLoadedJobsMutex;
+  std::vector<std::size_t> mLoadedJobs;
+  std::vector<std::size_t> mJobsToFinish;
+  std::size_t mNumFinishedJobs = 0;
+};
+
+} // namespace variant_talk
@@ -22,9 +22,6 @@
 #include "components.hpp"
 
 #include "config.hpp"
-#include "sfml_interop.hpp"
-
-#include <SFML/Graphics/Sprite.hpp>
 
 #include <algorithm>
 
@@ -34,6 +31,7 @@ namespace variant_talk
 
 MovingObject::MovingObject(Vec2 position, Vec2 size, Vec2 velocity)
   : mPosition(position)
+  , mPreviousPosition(position)
   , mSize(size)
   , mVelocity(velocity)
 {
@@ -64,6 +62,14 @@ Rect MovingObject::bbox() const
 }
 
 
+Rect MovingObject::interpolatedBbox(const float factor) const
+{
+  const auto position =
+    mPreviousPosition + (mPosition - mPreviousPosition) * factor;
+  return Rect{position, mSize};
+}
+
+
 Vec2& MovingObject::position()
 {
   return mPosition;
@@ -93,6 +99,8 @@ bool MovingObject::isMovingToPosition() const
 
 void MovingObject::update(const double timeDelta)
 {
+  mPreviousPosition = mPosition;
+
   const auto scaledVelocity = mVelocity * timeDelta;
   const auto newPosition = mPosition + scaledVelocity;
 
@@ -139,7 +147,14 @@ Projectile::Type DestructibleObject::affectingType() const
 }
 
 
-void AnimatedSprite::update(const double timeDelta)
+Animation::Animation(const std::size_t numFrames, const double delay)
+  : mNumFrames(numFrames)
+  , mDelay(delay)
+{
+}
+
+
+void Animation::update(const double timeDelta)
 {
   mElapsedSinceAnimationSwitch += timeDelta;
   if (mElapsedSinceAnimationSwitch >= mDelay)
@@ -153,21 +168,9 @@ void AnimatedSprite::update(const double timeDelta)
 }
 
 
-void AnimatedSprite::render(
-  sf::RenderWindow& window,
-  const Vec2& position,
-  const bool flipHorizontally)
+std::size_t Animation::frameIndex() const
 {
-  sf::Sprite sprite;
-  sprite.setTexture(mpFrames[mAnimationIndex]);
-  sprite.setPosition(toSfml(position));
-
-  if (flipHorizontally)
-  {
-    sprite.setScale(-1.0f, 1.0f);
-  }
-
-  window.draw(sprite);
+  return mAnimationIndex;
 }
 
 } // namespace variant_talk
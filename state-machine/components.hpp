@@ -21,11 +21,11 @@
 
 #pragma once
 
+#include "config.hpp"
 #include "math.hpp"
 
-#include <SFML/Graphics/RenderWindow.hpp>
-#include <SFML/Graphics/Texture.hpp>
-
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 
@@ -43,6 +43,10 @@ public:
 
   Rect bbox() const;
 
+  // Bounding box at the given point between the position before the last
+  // update() (0) and the current one (1), for rendering.
+  Rect interpolatedBbox(float factor) const;
+
   Vec2& position();
   Vec2& velocity();
 
@@ -53,6 +57,7 @@ public:
 
 private:
   Vec2 mPosition;
+  Vec2 mPreviousPosition;
   Vec2 mSize;
   Vec2 mVelocity;
 
@@ -60,30 +65,37 @@ private:
 };
 
 
+// ProjectileManager stores projectiles as structure of arrays, this is a copy
+// of a single one's state. All projectiles have the same size.
 struct Projectile
 {
-  enum class Type
+  enum class Type : std::uint8_t
   {
     Player,
     Enemy
   };
 
-  void update(const double timeDelta);
+  Rect bbox() const
+  {
+    return Rect{mPosition, {PROJECTILE_SIZE, PROJECTILE_SIZE}};
+  }
 
-  bool isOffScreen() const;
+  // See MovingObject::interpolatedBbox()
+  Rect interpolatedBbox(const float factor) const
+  {
+    const auto position =
+      mPreviousPosition + (mPosition - mPreviousPosition) * factor;
+    return Rect{position, {PROJECTILE_SIZE, PROJECTILE_SIZE}};
+  }
 
-  MovingObject mMovingObject;
+  Vec2 mPosition;
+  Vec2 mPreviousPosition;
+  Vec2 mVelocity;
   Type mType;
   bool mIsDestroyed = false;
 };
 
 
-inline void Projectile::update(const double timeDelta)
-{
-  mMovingObject.update(timeDelta);
-}
-
-
 
 class DestructibleObject
 {
@@ -100,29 +112,18 @@ private:
 };
 
 
-class AnimatedSprite
+// Cycles through the frames of a sprite animation. Drawing the current frame
+// is up to the renderer (see rendering.hpp).
+class Animation
 {
 public:
-  template<std::size_t numFrames>
-  AnimatedSprite(
-    const std::array<sf::Texture, numFrames>& frames,
-    const double delay
-  )
-    : mpFrames(frames.data())
-    , mNumFrames(numFrames)
-    , mDelay(delay)
-  {
-  }
+  Animation(std::size_t numFrames, double delay);
 
   void update(const double timeDelta);
 
-  void render(
-    sf::RenderWindow& window,
-    const Vec2& position,
-    bool flipHorizontally);
+  std::size_t frameIndex() const;
 
 private:
-  const sf::Texture* mpFrames = nullptr;
   std::size_t mNumFrames = 0;
   std::size_t mAnimationIndex = 0;
   double mDelay = 0.0;
@@ -24,6 +24,7 @@
 #include "math.hpp"
 
 #include <array>
+#include <cstddef>
 
 
 namespace variant_talk
@@ -55,13 +56,23 @@ constexpr auto PLAYER_WIDTH = 72;
 constexpr auto PLAYER_HEIGHT = 24;
 constexpr auto PLAYER_SPEED = 350.0f;
 
+constexpr auto NUM_ANIMATION_FRAMES = std::size_t{2};
+constexpr auto ANIMATION_FRAME_DELAY = 0.08;
+
 constexpr auto PROJECTILE_SIZE = 8.0f;
-constexpr auto PROJECTILE_RADIUS = PROJECTILE_SIZE / 2.0f;
 constexpr auto PLAYER_PROJECTILE_SPEED = 900.0f;
 constexpr auto ENEMY_PROJECTILE_SPEED = 250.0f;
 
+// Cell size of the collision grid, a bit larger than the ships
+constexpr auto COLLISION_CELL_SIZE = 80.0f;
+
 constexpr auto GAME_OVER_SCREEN_LOCK_TIME = 2.0;
 
+// At 120 ticks per second, even the fast player projectiles move less than
+// their own size per step, so they can't skip over anything.
+constexpr auto DEFAULT_TICK_RATE = 120.0;
+constexpr auto DEFAULT_MAX_STEPS_PER_FRAME = 8;
+
 constexpr auto MAX_HEALTH = 30;
 
 constexpr auto ENEMY_SHOT_DELAY = 1.2;
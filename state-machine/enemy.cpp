@@ -23,11 +23,12 @@
 
 #include "player.hpp"
 #include "projectiles.hpp"
-#include "sfml_interop.hpp"
 
 #include "match.hpp"
 
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <algorithm>
+#include <array>
+#include <tuple>
 
 
 namespace variant_talk
@@ -67,17 +68,14 @@ int cornerIndexWithMaxDistanceTo(const Vec2& referencePos)
 } // namespace
 
 
-Enemy::Enemy(
-  ProjectileManager* pProjectiles,
-  const Player* pPlayer,
-  ResourceBundle* pResources)
+Enemy::Enemy(ProjectileManager* pProjectiles, const Player* pPlayer)
   : mpProjectiles(pProjectiles)
   , mpPlayer(pPlayer)
   , mMovingObject{
       {CIRCLE_POSITIONS[3]},
       {PLAYER_WIDTH, PLAYER_HEIGHT},
       {}}
-  , mSprite(pResources->mOpponentTextures, 0.08)
+  , mAnimation(NUM_ANIMATION_FRAMES, ANIMATION_FRAME_DELAY)
   , mDestructible(MAX_HEALTH, Projectile::Type::Player)
 {
   flyTo(CIRCLE_POSITIONS[0]);
@@ -112,25 +110,13 @@ void Enemy::update(const double timeDelta)
     mFacingLeft = newXVel < 0.0f;
   }
 
-  mSprite.update(timeDelta);
-}
-
-
-void Enemy::render(sf::RenderWindow& window)
-{
-  const auto offset = mFacingLeft
-    ? Vec2{-(50.0f + PLAYER_WIDTH), 17.0f}
-    : Vec2{50.0f, 17.0f};
-  const auto position = mMovingObject.bbox().topLeft - offset;
-  const auto drawFlipped = mFacingLeft;
-
-  mSprite.render(window, position, drawFlipped);
+  mAnimation.update(timeDelta);
 }
 
 
 bool Enemy::playerInInnerZone() const
 {
-  return toSfml(mpPlayer->bbox()).intersects(toSfml(INNER_ZONE));
+  return intersects(mpPlayer->bbox(), INNER_ZONE);
 }
 
 
@@ -24,11 +24,8 @@
 #include "components.hpp"
 #include "config.hpp"
 #include "math.hpp"
-#include "resource_bundle.hpp"
 
-#include <SFML/Graphics/RenderWindow.hpp>
-
-#include <variant>
+#include "compact_variant.hpp"
 
 
 namespace variant_talk
@@ -74,7 +71,9 @@ struct FlyOut
 };
 
 
-using State = std::variant<
+// All states are trivially copyable, so the enemy's state can be stored without
+// std::variant's padding.
+using State = compact_variant<
   Circling,
   FlyToCenter,
   ShootingFromCenter,
@@ -84,17 +83,16 @@ using State = std::variant<
 class Enemy
 {
 public:
-  Enemy(
-    ProjectileManager* pProjectiles,
-    const Player* pPlayer,
-    ResourceBundle* pResources);
+  Enemy(ProjectileManager* pProjectiles, const Player* pPlayer);
 
   void update(const double timeDelta);
 
-  void render(sf::RenderWindow& window);
-
   int health() const;
   const State& state() const;
+  Rect bbox() const;
+  Rect interpolatedBbox(float factor) const;
+  bool isFacingLeft() const;
+  const Animation& animation() const;
 
   bool playerInInnerZone() const;
   bool playerInOuterZone() const;
@@ -113,7 +111,7 @@ private:
 
   State mState;
   MovingObject mMovingObject;
-  AnimatedSprite mSprite;
+  Animation mAnimation;
   bool mFacingLeft = true;
   DestructibleObject mDestructible;
 };
@@ -130,4 +128,28 @@ inline const State& Enemy::state() const
   return mState;
 }
 
+
+inline Rect Enemy::bbox() const
+{
+  return mMovingObject.bbox();
+}
+
+
+inline Rect Enemy::interpolatedBbox(const float factor) const
+{
+  return mMovingObject.interpolatedBbox(factor);
+}
+
+
+inline bool Enemy::isFacingLeft() const
+{
+  return mFacingLeft;
+}
+
+
+inline const Animation& Enemy::animation() const
+{
+  return mAnimation;
+}
+
 } // namespace variant_talk
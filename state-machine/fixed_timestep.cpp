@@ -0,0 +1,63 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "fixed_timestep.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace variant_talk
+{
+
+FixedTimestep::FixedTimestep(
+  const double ticksPerSecond,
+  const int maxStepsPerFrame
+)
+  : mStepSize(1.0 / ticksPerSecond)
+  , mMaxStepsPerFrame(std::max(maxStepsPerFrame, 1))
+{
+}
+
+
+int FixedTimestep::advance(const double elapsedTime)
+{
+  mAccumulatedTime += std::max(elapsedTime, 0.0);
+
+  const auto numSteps = std::floor(mAccumulatedTime / mStepSize);
+  if (numSteps > static_cast<double>(mMaxStepsPerFrame))
+  {
+    mAccumulatedTime = std::fmod(mAccumulatedTime, mStepSize);
+    return mMaxStepsPerFrame;
+  }
+
+  mAccumulatedTime -= numSteps * mStepSize;
+  return static_cast<int>(numSteps);
+}
+
+
+float FixedTimestep::interpolationFactor() const
+{
+  const auto factor = std::clamp(mAccumulatedTime / mStepSize, 0.0, 1.0);
+  return static_cast<float>(factor);
+}
+
+} // namespace variant_talk
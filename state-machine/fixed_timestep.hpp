@@ -0,0 +1,59 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+namespace variant_talk
+{
+
+// Turns variable frame times into a whole number of fixed size simulation
+// steps, so that the simulation's results don't depend on the frame rate.
+//
+// Time which isn't enough for a full step is carried over to the next frame.
+// How far it reaches into the next step is the interpolation factor, which
+// the renderer uses to blend between the previous and the current simulation
+// state. If a frame took so long that more than maxStepsPerFrame steps would
+// be needed to catch up, the excess time is dropped, i.e. the simulation slows
+// down instead of spending ever more time on catching up.
+class FixedTimestep
+{
+public:
+  FixedTimestep(double ticksPerSecond, int maxStepsPerFrame);
+
+  // Returns the number of steps to simulate for the given frame time
+  int advance(double elapsedTime);
+
+  double stepSize() const
+  {
+    return mStepSize;
+  }
+
+  // Between 0 (previous step) and 1 (current step)
+  float interpolationFactor() const;
+
+private:
+  double mStepSize;
+  int mMaxStepsPerFrame;
+  double mAccumulatedTime = 0.0;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,104 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "game_world.hpp"
+
+#include <cstring>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+class Fnv1aHash
+{
+public:
+  template <typename T>
+  void add(const T& value)
+  {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+
+    for (const auto byte : bytes)
+    {
+      mHash = (mHash ^ byte) * 0x100000001b3;
+    }
+  }
+
+  void add(const Rect& rect)
+  {
+    add(rect.topLeft.x);
+    add(rect.topLeft.y);
+    add(rect.size.x);
+    add(rect.size.y);
+  }
+
+  std::uint64_t value() const
+  {
+    return mHash;
+  }
+
+private:
+  std::uint64_t mHash = 0xcbf29ce484222325;
+};
+
+} // namespace
+
+
+GameWorld::GameWorld()
+  : mPlayer(&mProjectiles)
+  , mEnemy(&mProjectiles, &mPlayer)
+{
+}
+
+
+void GameWorld::update(const double timeDelta)
+{
+  mProjectiles.update(timeDelta);
+  mPlayer.update(mInputState, timeDelta);
+  mEnemy.update(timeDelta);
+}
+
+
+std::uint64_t GameWorld::stateHash() const
+{
+  Fnv1aHash hash;
+
+  hash.add(mPlayer.bbox());
+  hash.add(mPlayer.health());
+  hash.add(mEnemy.bbox());
+  hash.add(mEnemy.health());
+  hash.add(mEnemy.state().index());
+
+  for (auto i = std::size_t{0}; i < mProjectiles.size(); ++i)
+  {
+    const auto projectile = mProjectiles.projectile(i);
+    hash.add(projectile.bbox());
+    hash.add(projectile.mVelocity.x);
+    hash.add(projectile.mVelocity.y);
+  }
+
+  return hash.value();
+}
+
+} // namespace variant_talk
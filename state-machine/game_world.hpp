@@ -0,0 +1,60 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "enemy.hpp"
+#include "player.hpp"
+#include "projectiles.hpp"
+
+#include <cstdint>
+
+
+namespace variant_talk
+{
+
+// The game's simulation, without any rendering or platform dependencies.
+struct GameWorld
+{
+  GameWorld();
+
+  GameWorld(const GameWorld&) = delete;
+  GameWorld& operator=(const GameWorld&) = delete;
+
+  void update(double timeDelta);
+
+  bool gameEnded() const
+  {
+    return mPlayer.health() == 0 || mEnemy.health() == 0;
+  }
+
+  // Hash over the exact bit patterns of the simulation state, for checking
+  // that identical inputs give identical results.
+  std::uint64_t stateHash() const;
+
+  InputState mInputState;
+
+  ProjectileManager mProjectiles;
+  Player mPlayer;
+  Enemy mEnemy;
+};
+
+} // namespace variant_talk
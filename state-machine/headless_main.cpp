@@ -0,0 +1,248 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Runs the game's simulation without a window, as fast as possible.
+//
+// GameWorld::update() is stepped at a fixed tick rate, while the player is
+// controlled by a scripted input sequence. When a round ends, a new one is
+// started right away. Reports the number of simulated frames per second, e.g.
+// for running the game logic on a server without a display or GPU, and a hash
+// of the final state. The simulation is deterministic, so the hash only
+// changes if the input or the game logic does.
+
+#include "config.hpp"
+#include "game_world.hpp"
+
+#include "match.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+using namespace variant_talk;
+
+namespace
+{
+
+namespace cr = std::chrono;
+using Clock = cr::steady_clock;
+
+
+struct Options
+{
+  std::uint64_t mNumFrames = 1'000'000;
+  double mTickRate = DEFAULT_TICK_RATE;
+};
+
+
+struct ScriptStep
+{
+  double mDuration;
+  Vec2 mDirection;
+  bool mIsFiring;
+};
+
+
+// Sweeps the player through the inner and outer zones, so that the enemy
+// goes through all of its states
+constexpr auto INPUT_SCRIPT = std::array<ScriptStep, 6>{
+  ScriptStep{0.8, Vec2{1.0f, 0.0f}, true},
+  ScriptStep{0.6, Vec2{0.0f, 1.0f}, true},
+  ScriptStep{1.5, Vec2{0.0f, 0.0f}, true},
+  ScriptStep{0.8, Vec2{-1.0f, 0.0f}, true},
+  ScriptStep{0.6, Vec2{0.0f, -1.0f}, false},
+  ScriptStep{1.0, Vec2{0.0f, 0.0f}, true},
+};
+
+// Firing needs the button to be released in between shots
+constexpr auto FIRE_BUTTON_PERIOD = 0.2;
+
+
+double scriptDuration()
+{
+  auto duration = 0.0;
+  for (const auto& step : INPUT_SCRIPT)
+  {
+    duration += step.mDuration;
+  }
+
+  return duration;
+}
+
+
+InputState scriptedInput(const double time)
+{
+  static const auto duration = scriptDuration();
+
+  auto timeInScript = std::fmod(time, duration);
+
+  for (const auto& step : INPUT_SCRIPT)
+  {
+    if (timeInScript < step.mDuration)
+    {
+      const auto isFireButtonDown =
+        std::fmod(time, FIRE_BUTTON_PERIOD) < FIRE_BUTTON_PERIOD / 2;
+      return InputState{step.mDirection, step.mIsFiring && isFireButtonDown};
+    }
+
+    timeInScript -= step.mDuration;
+  }
+
+  return InputState{};
+}
+
+
+// Throws std::invalid_argument or std::out_of_range for malformed numbers
+std::optional<Options> parseArguments(const int argc, char** argv)
+{
+  Options options;
+
+  for (auto i = 1; i + 1 < argc; i += 2)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string{argv[i + 1]};
+
+    if (arg == "--frames")
+    {
+      options.mNumFrames = std::stoull(value);
+    }
+    else if (arg == "--tick-rate")
+    {
+      options.mTickRate = std::stod(value);
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (argc % 2 == 0 || options.mTickRate <= 0.0)
+  {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+
+std::optional<Options> parseOptions(const int argc, char** argv)
+{
+  try
+  {
+    return parseArguments(argc, argv);
+  }
+  catch (const std::logic_error&)
+  {
+    return std::nullopt;
+  }
+}
+
+
+void run(const Options& options)
+{
+  const auto timeStep = 1.0 / options.mTickRate;
+
+  auto pWorld = std::make_unique<GameWorld>();
+  auto numPlayerWins = std::uint64_t{0};
+  auto numEnemyWins = std::uint64_t{0};
+  auto simulatedTime = 0.0;
+
+  const auto start = Clock::now();
+
+  for (auto frame = std::uint64_t{0}; frame < options.mNumFrames; ++frame)
+  {
+    pWorld->mInputState = scriptedInput(simulatedTime);
+    pWorld->update(timeStep);
+    simulatedTime += timeStep;
+
+    if (pWorld->gameEnded())
+    {
+      if (pWorld->mPlayer.health() > 0)
+      {
+        ++numPlayerWins;
+      }
+      else
+      {
+        ++numEnemyWins;
+      }
+
+      pWorld = std::make_unique<GameWorld>();
+    }
+  }
+
+  const auto elapsed = cr::duration<double>{Clock::now() - start}.count();
+
+  auto& report = std::cerr;
+  report << std::fixed << std::setprecision(1)
+    << "frames:             " << options.mNumFrames << '\n'
+    << "simulated time:     " << simulatedTime << " s\n"
+    << std::setprecision(3)
+    << "elapsed:            " << elapsed << " s\n"
+    << std::setprecision(1)
+    << "frames/s:           "
+    << static_cast<double>(options.mNumFrames) / elapsed << '\n'
+    << "speedup:            " << simulatedTime / elapsed << "x real time\n"
+    << "rounds won:         " << numPlayerWins << " player, "
+    << numEnemyWins << " enemy\n"
+    << "final state hash:   " << std::hex << pWorld->stateHash() << std::dec
+    << '\n';
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  const auto options = parseOptions(argc, argv);
+  if (!options)
+  {
+    std::cerr <<
+      "Usage: state_machine_headless [--frames N]\n"
+      "                              [--tick-rate ticks_per_second]\n";
+    return 1;
+  }
+
+  try
+  {
+    run(*options);
+  }
+  catch (const std::exception& error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  printMatchStatistics(std::cerr);
+#endif
+
+  return 0;
+}
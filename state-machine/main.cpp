@@ -19,19 +19,30 @@
  * SOFTWARE.
  */
 
-#include "enemy.hpp"
-#include "player.hpp"
-#include "projectiles.hpp"
+#include "asset_loader.hpp"
+#include "fixed_timestep.hpp"
+#include "game_world.hpp"
+#include "rendering.hpp"
+#include "resource_bundle.hpp"
+#include "resource_pack.hpp"
+#include "text_cache.hpp"
 
 #include "match.hpp"
 
 #include <SFML/Graphics.hpp>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 
 using namespace variant_talk;
@@ -48,44 +59,32 @@ constexpr auto STATE_NAMES = std::array<const char*, NUM_STATES>{
   "FlyOut"
 };
 
+// Created at build time from the files in resources/, see pack_resources.cpp
+constexpr auto RESOURCE_PACK_PATH = "resources.pack";
 
-struct GameWorld
-{
-  GameWorld(ResourceBundle* pResources);
-
-  GameWorld(const GameWorld&) = delete;
-  GameWorld& operator=(const GameWorld&) = delete;
+// All character sizes used by the UI, for prewarming the font's glyph cache
+constexpr auto UI_CHARACTER_SIZES = std::array<unsigned, 3>{14, 16, 48};
+constexpr auto PRINTABLE_ASCII =
+  std::string_view{" !\"#$%&'()*+,-./0123456789:;<=>?@"
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"};
 
-  void handleEvent(const sf::Event& event);
 
-  void update(double timeDelta)
-  {
-    mProjectiles.update(timeDelta);
-    mPlayer.update(mInputState, timeDelta);
-    mEnemy.update(timeDelta);
-  }
-
-  void render(sf::RenderWindow& window)
-  {
-    mPlayer.render(window);
-    mEnemy.render(window);
-    mProjectiles.render(window);
-  }
-
-  bool gameEnded() const
-  {
-    return mPlayer.health() == 0 || mEnemy.health() == 0;
-  }
+void uploadTexture(sf::Texture& texture, const PackedResource& image)
+{
+  texture.create(image.mWidth, image.mHeight);
+  texture.update(image.mpData);
+}
 
-  InputState mInputState;
 
-  ProjectileManager mProjectiles;
-  Player mPlayer;
-  Enemy mEnemy;
-};
+sf::Image toImage(const PackedResource& image)
+{
+  sf::Image result;
+  result.create(image.mWidth, image.mHeight, image.mpData);
+  return result;
+}
 
 
-void GameWorld::handleEvent(const sf::Event& event)
+void updateInputState(InputState& inputState, const sf::Event& event)
 {
   const auto isPressed = event.type == sf::Event::KeyPressed;
   const auto isPressedAsFloat = isPressed ? 1.0f : 0.0f;
@@ -93,23 +92,23 @@ void GameWorld::handleEvent(const sf::Event& event)
   switch (event.key.code)
   {
     case sf::Keyboard::Left:
-      mInputState.direction.x = -isPressedAsFloat;
+      inputState.direction.x = -isPressedAsFloat;
       break;
 
     case sf::Keyboard::Right:
-      mInputState.direction.x = isPressedAsFloat;
+      inputState.direction.x = isPressedAsFloat;
       break;
 
     case sf::Keyboard::Up:
-      mInputState.direction.y = -isPressedAsFloat;
+      inputState.direction.y = -isPressedAsFloat;
       break;
 
     case sf::Keyboard::Down:
-      mInputState.direction.y = isPressedAsFloat;
+      inputState.direction.y = isPressedAsFloat;
       break;
 
     case sf::Keyboard::Space:
-      mInputState.firePressed = isPressed;
+      inputState.firePressed = isPressed;
       break;
 
     default:
@@ -124,7 +123,12 @@ public:
   explicit Game(sf::RenderWindow& window);
 
   void handleEvent(const sf::Event& event);
-  void updateAndRender(const double timeDelta);
+  void update(double timeDelta);
+  void render(float interpolation);
+
+  // Assets are loaded in the background. Until they are all there, the game
+  // doesn't advance, and render() only shows a progress bar.
+  bool isLoaded() const;
 
 private:
   enum class Party
@@ -143,16 +147,48 @@ private:
 
   using State = std::variant<InGame, GameOver>;
 
-  void update(double timeDelta);
-  void render();
-  void renderBackground();
-  void renderUi(int playerHealth, int enemyHealth);
+  // Everything the overlay layer (UI area and info panel) depends on
+  struct OverlayKey
+  {
+    int mPlayerHealth = 0;
+    int mEnemyHealth = 0;
+    std::optional<std::size_t> mEnemyStateIndex; // empty when game is over
+    bool mPlayerInInnerZone = false;
+
+    bool operator==(const OverlayKey& other) const
+    {
+      return
+        std::tie(
+          mPlayerHealth, mEnemyHealth, mEnemyStateIndex, mPlayerInInnerZone) ==
+        std::tie(
+          other.mPlayerHealth,
+          other.mEnemyHealth,
+          other.mEnemyStateIndex,
+          other.mPlayerInInnerZone);
+    }
+  };
+
+  void loadFromPack();
+  void startLoadingFiles();
+  void continueLoading();
+  void renderLoadingScreen();
+
+  void createLayers();
+  void updateOverlay(const OverlayKey& key);
+  void drawLayer(const sf::RenderTexture& layer);
+
+  void renderBackground(sf::RenderTarget& target);
+  void renderUi(sf::RenderTarget& target, int playerHealth, int enemyHealth);
   void renderGameEndMessage(Party winningParty);
-  void renderStateMachineVisualization(const GameWorld& world);
+  void renderStateMachineVisualization(
+    sf::RenderTarget& target,
+    std::size_t enemyStateIndex,
+    bool playerInInnerZone);
 
-  sf::FloatRect measureText(int characterSize, std::string_view string) const;
+  sf::FloatRect measureText(int characterSize, std::string_view string);
 
   void drawText(
+    sf::RenderTarget& target,
     float x,
     float y,
     int characterSize,
@@ -160,6 +196,7 @@ private:
     std::string_view string);
 
   void drawRect(
+    sf::RenderTarget& target,
     float x,
     float y,
     float width,
@@ -168,46 +205,269 @@ private:
 
   sf::RenderWindow& mWindow;
 
+  AssetLoader mAssetLoader;
+  bool mIsLoaded = false;
+
+  // The font is read from either of these on demand, so they need to stay
+  // around as long as the font
+  std::optional<ResourcePackReader> mResourcePack;
+  std::vector<char> mFontData;
   sf::Font mFont;
+  TextCache mTextCache;
   sf::Texture mBackground;
   ResourceBundle mResources;
+  SpriteBatch mSpriteBatch;
+  ProjectileRenderer mProjectileRenderer;
 
   std::array<sf::Texture, NUM_STATES> mStateVisualizations;
 
+  // Parts of the screen which change rarely (if at all) are drawn into these
+  // render textures, and only redrawn when they change. They cover the whole
+  // view, at the window's resolution.
+  sf::RenderTexture mBackgroundLayer;
+  sf::RenderTexture mOverlayLayer;
+  std::optional<OverlayKey> mOverlayKey;
+  float mLayerScale = 1.0f;
+
   State mState;
 };
 
 
-GameWorld::GameWorld(ResourceBundle* pResources)
-  : mPlayer(&mProjectiles, pResources)
-  , mEnemy(&mProjectiles, &mPlayer, pResources)
+Game::Game(sf::RenderWindow& window)
+  : mWindow(window)
+  , mTextCache(mFont)
+  , mSpriteBatch(mResources.mAtlas.texture())
+  , mState(std::make_unique<GameWorld>())
 {
+  try
+  {
+    loadFromPack();
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cerr << error.what() << ", loading individual files instead\n";
+
+    mResourcePack.reset();
+    startLoadingFiles();
+  }
+
+  createLayers();
 }
 
 
-Game::Game(sf::RenderWindow& window)
-  : mWindow(window)
-  , mState(std::make_unique<GameWorld>(&mResources))
+// Uploads the pre-decoded pixels from the pack straight to the GPU.
+void Game::loadFromPack()
 {
   using namespace std::literals;
 
-  const auto kBasePath = "resources/"s;
+  const auto& pack = mResourcePack.emplace(RESOURCE_PACK_PATH);
+
+  // Everything is looked up before anything is used, so that an incomplete
+  // pack is rejected as a whole
+  const auto font = pack.get("DroidSans.ttf");
+  const auto background = pack.get("space-bg.jpg");
+
+  auto stateVisualizations = std::array<PackedResource, NUM_STATES>{};
+  for (auto i = 0u; i < NUM_STATES; ++i)
+  {
+    stateVisualizations[i] = pack.get(STATE_NAMES[i] + ".png"s);
+  }
+
+  const auto playerFrames = std::array<PackedResource, NUM_ANIMATION_FRAMES>{
+    pack.get("player1.png"), pack.get("player2.png")};
+  const auto opponentFrames = std::array<PackedResource, NUM_ANIMATION_FRAMES>{
+    pack.get("opponent1.png"), pack.get("opponent2.png")};
+
+  mFont.loadFromMemory(font.mpData, font.mSize);
 
-  mFont.loadFromFile(kBasePath + "DroidSans.ttf");
-  mBackground.loadFromFile(kBasePath + "space-bg.jpg");
+  uploadTexture(mBackground, background);
   mBackground.setSmooth(true);
 
   for (auto i = 0u; i < NUM_STATES; ++i)
   {
-    mStateVisualizations[i].loadFromFile(kBasePath + STATE_NAMES[i] + ".png");
+    uploadTexture(mStateVisualizations[i], stateVisualizations[i]);
     mStateVisualizations[i].setSmooth(true);
   }
 
-  mResources.mPlayerTextures[0].loadFromFile(kBasePath + "player1.png");
-  mResources.mPlayerTextures[1].loadFromFile(kBasePath + "player2.png");
+  for (auto i = 0u; i < NUM_ANIMATION_FRAMES; ++i)
+  {
+    mResources.mPlayerFrames[i] =
+      mResources.mAtlas.add(toImage(playerFrames[i]));
+    mResources.mOpponentFrames[i] =
+      mResources.mAtlas.add(toImage(opponentFrames[i]));
+  }
+}
 
-  mResources.mOpponentTextures[0].loadFromFile(kBasePath + "opponent1.png");
-  mResources.mOpponentTextures[1].loadFromFile(kBasePath + "opponent2.png");
+
+// Fallback for when there is no resource pack, e.g. when running from the
+// source directory. Decodes the original files in the background.
+void Game::startLoadingFiles()
+{
+  using namespace std::literals;
+
+  const auto kBasePath = "resources/"s;
+
+  mAssetLoader.loadFile(kBasePath + "DroidSans.ttf",
+    [this](std::vector<char>& contents)
+    {
+      mFontData = std::move(contents);
+      mFont.loadFromMemory(mFontData.data(), mFontData.size());
+    });
+
+  mAssetLoader.loadImage(kBasePath + "space-bg.jpg",
+    [this](const sf::Image& image)
+    {
+      mBackground.loadFromImage(image);
+      mBackground.setSmooth(true);
+    });
+
+  for (auto i = 0u; i < NUM_STATES; ++i)
+  {
+    mAssetLoader.loadImage(kBasePath + STATE_NAMES[i] + ".png",
+      [this, i](const sf::Image& image)
+      {
+        mStateVisualizations[i].loadFromImage(image);
+        mStateVisualizations[i].setSmooth(true);
+      });
+  }
+
+  const auto addToAtlas =
+    [this, &kBasePath](const char* fileName, TextureAtlas::ImageId& id)
+    {
+      mAssetLoader.loadImage(kBasePath + fileName,
+        [this, &id](const sf::Image& image)
+        {
+          id = mResources.mAtlas.add(image);
+        });
+    };
+
+  addToAtlas("player1.png", mResources.mPlayerFrames[0]);
+  addToAtlas("player2.png", mResources.mPlayerFrames[1]);
+  addToAtlas("opponent1.png", mResources.mOpponentFrames[0]);
+  addToAtlas("opponent2.png", mResources.mOpponentFrames[1]);
+
+  mAssetLoader.start();
+}
+
+
+bool Game::isLoaded() const
+{
+  return mIsLoaded;
+}
+
+
+void Game::continueLoading()
+{
+  mAssetLoader.poll();
+  if (!mAssetLoader.isDone())
+  {
+    return;
+  }
+
+  // Everything which depends on more than one asset
+  for (const auto characterSize : UI_CHARACTER_SIZES)
+  {
+    mTextCache.prewarm(PRINTABLE_ASCII, characterSize);
+  }
+
+  mResources.mAtlas.pack();
+
+  // The background never changes
+  mBackgroundLayer.clear(sf::Color::Transparent);
+  renderBackground(mBackgroundLayer);
+  mBackgroundLayer.display();
+
+  mIsLoaded = true;
+}
+
+
+void Game::renderLoadingScreen()
+{
+  constexpr auto LOADING_BAR_WIDTH = 400.0f;
+  constexpr auto LOADING_BAR_HEIGHT = 8.0f;
+  constexpr auto LOADING_BAR_X = (VIEW_WIDTH - LOADING_BAR_WIDTH) / 2.0f;
+  constexpr auto LOADING_BAR_Y = (VIEW_HEIGHT - LOADING_BAR_HEIGHT) / 2.0f;
+
+  const auto progress =
+    static_cast<float>(mAssetLoader.numFinishedAssets()) /
+    static_cast<float>(std::max(mAssetLoader.numAssets(), std::size_t{1}));
+
+  mWindow.clear(sf::Color::Black);
+  drawRect(
+    mWindow,
+    LOADING_BAR_X, LOADING_BAR_Y,
+    LOADING_BAR_WIDTH, LOADING_BAR_HEIGHT,
+    sf::Color{90, 90, 90});
+  drawRect(
+    mWindow,
+    LOADING_BAR_X, LOADING_BAR_Y,
+    LOADING_BAR_WIDTH * progress, LOADING_BAR_HEIGHT,
+    sf::Color{0, 200, 0});
+  mWindow.display();
+}
+
+
+void Game::createLayers()
+{
+  const auto windowSize = mWindow.getSize();
+  mLayerScale = std::max({
+    static_cast<float>(windowSize.x) / VIEW_WIDTH,
+    static_cast<float>(windowSize.y) / VIEW_HEIGHT,
+    1.0f});
+
+  const auto layerView =
+    sf::View{sf::FloatRect(0.0f, 0.0f, VIEW_WIDTH, VIEW_HEIGHT)};
+
+  for (auto pLayer : {&mBackgroundLayer, &mOverlayLayer})
+  {
+    pLayer->create(
+      static_cast<unsigned>(std::ceil(VIEW_WIDTH * mLayerScale)),
+      static_cast<unsigned>(std::ceil(VIEW_HEIGHT * mLayerScale)));
+    pLayer->setSmooth(true);
+    pLayer->setView(layerView);
+  }
+}
+
+
+void Game::updateOverlay(const OverlayKey& key)
+{
+  if (mOverlayKey == key)
+  {
+    return;
+  }
+
+  mOverlayKey = key;
+
+  mOverlayLayer.clear(sf::Color::Transparent);
+
+  renderUi(mOverlayLayer, key.mPlayerHealth, key.mEnemyHealth);
+
+  if (key.mEnemyStateIndex)
+  {
+    renderStateMachineVisualization(
+      mOverlayLayer, *key.mEnemyStateIndex, key.mPlayerInInnerZone);
+  }
+  else
+  {
+    // Info area background
+    drawRect(
+      mOverlayLayer,
+      PLAY_AREA_WIDTH, 0,
+      INFO_AREA_WIDTH, PLAY_AREA_HEIGHT,
+      sf::Color{180, 180, 180});
+  }
+
+  mOverlayLayer.display();
+}
+
+
+void Game::drawLayer(const sf::RenderTexture& layer)
+{
+  sf::Sprite sprite;
+  sprite.setTexture(layer.getTexture());
+  sprite.setScale(1.0f / mLayerScale, 1.0f / mLayerScale);
+
+  mWindow.draw(sprite);
 }
 
 
@@ -225,15 +485,15 @@ void Game::handleEvent(const sf::Event& event)
   auto maybeNextState = match(mState,
     [&](InGame& state) -> MaybeNextState
     {
-      state->handleEvent(event);
+      updateInputState(state->mInputState, event);
       return std::nullopt;
     },
 
-    [this](const GameOver& state) -> MaybeNextState
+    [](const GameOver& state) -> MaybeNextState
     {
       if (state.mTimeElapsed >= GAME_OVER_SCREEN_LOCK_TIME)
       {
-        return State{std::make_unique<GameWorld>(&mResources)};
+        return State{std::make_unique<GameWorld>()};
       }
 
       return std::nullopt;
@@ -246,17 +506,15 @@ void Game::handleEvent(const sf::Event& event)
 }
 
 
-void Game::updateAndRender(const double timeDelta)
-{
-  update(timeDelta);
-  render();
-}
-
-
 void Game::update(const double timeDelta)
 {
+  if (!mIsLoaded)
+  {
+    return;
+  }
+
   using MaybeNextState = std::optional<State>;
-  auto maybeNextState = match(mState,
+  auto maybeNextState = match_likely<InGame>(mState,
     [timeDelta](InGame& state) -> MaybeNextState
     {
       state->update(timeDelta);
@@ -284,27 +542,45 @@ void Game::update(const double timeDelta)
 }
 
 
-void Game::render()
+void Game::render(const float interpolation)
 {
-  renderBackground();
+  if (!mIsLoaded)
+  {
+    continueLoading();
+
+    if (!mIsLoaded)
+    {
+      renderLoadingScreen();
+      return;
+    }
+  }
 
-  match(mState,
-    [this](const InGame& state)
+  drawLayer(mBackgroundLayer);
+
+  match_likely<InGame>(mState,
+    [this, interpolation](const InGame& state)
     {
-      state->render(mWindow);
-      renderUi(state->mPlayer.health(), state->mEnemy.health());
-      renderStateMachineVisualization(*state);
+      variant_talk::render(
+        mWindow,
+        *state,
+        mResources,
+        mSpriteBatch,
+        mProjectileRenderer,
+        interpolation);
+
+      updateOverlay(OverlayKey{
+        state->mPlayer.health(),
+        state->mEnemy.health(),
+        state->mEnemy.state().index(),
+        state->mEnemy.playerInInnerZone()});
+      drawLayer(mOverlayLayer);
     },
 
     [this](const GameOver& state)
     {
-      // Info area background
-      drawRect(
-        PLAY_AREA_WIDTH, 0,
-        INFO_AREA_WIDTH, PLAY_AREA_HEIGHT,
-        sf::Color{180, 180, 180});
+      updateOverlay(OverlayKey{});
+      drawLayer(mOverlayLayer);
 
-      renderUi(0, 0);
       renderGameEndMessage(state.mWinningParty);
     });
 
@@ -312,7 +588,7 @@ void Game::render()
 }
 
 
-void Game::renderBackground()
+void Game::renderBackground(sf::RenderTarget& target)
 {
   constexpr auto kScale = 0.5f;
 
@@ -321,11 +597,14 @@ void Game::renderBackground()
   background.setScale(kScale, kScale);
   background.setPosition(0, UI_AREA_HEIGHT);
 
-  mWindow.draw(background);
+  target.draw(background);
 }
 
 
-void Game::renderUi(const int playerHealth, const int enemyHealth)
+void Game::renderUi(
+  sf::RenderTarget& target,
+  const int playerHealth,
+  const int enemyHealth)
 {
   auto darken = [](const sf::Uint8 color)
   {
@@ -342,11 +621,13 @@ void Game::renderUi(const int playerHealth, const int enemyHealth)
     auto& d = darken;
 
     drawRect(
+      target,
       startX, BAR_START_Y,
       BAR_WIDTH, BAR_HEIGHT,
       sf::Color{d(r), d(g), d(b), 180});
 
     drawRect(
+      target,
       startX + BAR_PADDING, BAR_START_Y + BAR_PADDING,
       health * (BAR_WIDTH - BAR_PADDING * 2), BAR_HEIGHT - BAR_PADDING * 2,
       sf::Color{r, g, b, 180});
@@ -357,10 +638,17 @@ void Game::renderUi(const int playerHealth, const int enemyHealth)
     return static_cast<float>(health) / MAX_HEALTH;
   };
 
-  drawRect(0, 0, PLAY_AREA_WIDTH, UI_AREA_HEIGHT, sf::Color{90, 90, 90});
+  drawRect(
+    target, 0, 0, PLAY_AREA_WIDTH, UI_AREA_HEIGHT, sf::Color{90, 90, 90});
 
-  drawText(PLAYER_BAR_START_X, TEXT_START_Y, 16, sf::Color::White, "Player");
-  drawText(ENEMY_BAR_START_X, TEXT_START_Y, 16, sf::Color::White, "Enemy");
+  drawText(
+    target,
+    PLAYER_BAR_START_X, TEXT_START_Y,
+    16, sf::Color::White, "Player");
+  drawText(
+    target,
+    ENEMY_BAR_START_X, TEXT_START_Y,
+    16, sf::Color::White, "Enemy");
 
   drawHealthBar(PLAYER_BAR_START_X, 0, 255, 0, normalize(playerHealth));
   drawHealthBar(ENEMY_BAR_START_X, 255, 0, 0, normalize(enemyHealth));
@@ -375,7 +663,10 @@ void Game::renderGameEndMessage(const Party winningParty)
     : "Try again...";
   const auto textSize = measureText(48, message);
 
+  // Drawn straight to the window, as text would lose its anti-aliasing when
+  // drawn onto the transparent parts of a layer
   drawText(
+    mWindow,
     PLAY_AREA_WIDTH / 2.0f - textSize.width / 2.0f,
     PLAY_AREA_HEIGHT / 2.0f - textSize.height / 2.0f,
     characterSize,
@@ -384,28 +675,33 @@ void Game::renderGameEndMessage(const Party winningParty)
 }
 
 
-void Game::renderStateMachineVisualization(const GameWorld& world)
+void Game::renderStateMachineVisualization(
+  sf::RenderTarget& target,
+  const std::size_t enemyStateIndex,
+  const bool playerInInnerZone)
 {
   drawRect(
+    target,
     PLAY_AREA_WIDTH, 0,
     INFO_AREA_WIDTH, PLAY_AREA_HEIGHT,
     sf::Color{180, 180, 180});
 
   {
     sf::Sprite sprite;
-    sprite.setTexture(mStateVisualizations[world.mEnemy.state().index()]);
+    sprite.setTexture(mStateVisualizations[enemyStateIndex]);
     sprite.setPosition(PLAY_AREA_WIDTH, 25);
     sprite.setScale(0.5f, 0.5f);
 
-    mWindow.draw(sprite);
+    target.draw(sprite);
   }
 
   {
-    const auto message = world.mEnemy.playerInInnerZone()
+    const auto message = playerInInnerZone
       ? "Player in INNER zone"
       : "Player in OUTER zone";
 
     drawText(
+      target,
       PLAY_AREA_WIDTH + 10,
       5,
       14,
@@ -416,39 +712,34 @@ void Game::renderStateMachineVisualization(const GameWorld& world)
 
 
 void Game::drawText(
+  sf::RenderTarget& target,
   const float x,
   const float y,
   const int characterSize,
   const sf::Color& color,
   std::string_view string)
 {
-  sf::Text text;
-  text.setFont(mFont);
+  const auto& text = mTextCache.get(string, characterSize, color);
 
-  text.setPosition(x, y);
-  text.setCharacterSize(characterSize);
-  text.setFillColor(color);
-  text.setString(std::string(string));
+  sf::RenderStates states;
+  states.transform.translate(x, y);
 
-  mWindow.draw(text);
+  target.draw(text, states);
 }
 
 
 sf::FloatRect Game::measureText(
   const int characterSize,
-  const std::string_view string) const
+  const std::string_view string)
 {
-  sf::Text text;
-  text.setFont(mFont);
-
-  text.setCharacterSize(characterSize);
-  text.setString(std::string(string));
-
-  return text.getLocalBounds();
+  // Same color as used for drawing, so that both share the cache entry
+  return mTextCache.get(string, characterSize, sf::Color::White)
+    .getLocalBounds();
 }
 
 
 void Game::drawRect(
+  sf::RenderTarget& target,
   const float x,
   const float y,
   const float width,
@@ -460,7 +751,72 @@ void Game::drawRect(
   rect.setSize(sf::Vector2f{width, height});
   rect.setFillColor(color);
 
-  mWindow.draw(rect);
+  target.draw(rect);
+}
+
+
+struct Options
+{
+  double mTickRate = DEFAULT_TICK_RATE;
+  int mMaxStepsPerFrame = DEFAULT_MAX_STEPS_PER_FRAME;
+};
+
+
+// Throws std::invalid_argument or std::out_of_range for malformed numbers
+std::optional<Options> parseArguments(const int argc, char** argv)
+{
+  Options options;
+
+  for (auto i = 1; i + 1 < argc; i += 2)
+  {
+    const auto arg = std::string_view{argv[i]};
+    const auto value = std::string{argv[i + 1]};
+
+    if (arg == "--tick-rate")
+    {
+      options.mTickRate = std::stod(value);
+    }
+    else if (arg == "--max-catch-up-steps")
+    {
+      options.mMaxStepsPerFrame = std::stoi(value);
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (argc % 2 == 0 || options.mTickRate <= 0.0 ||
+      options.mMaxStepsPerFrame < 1)
+  {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+
+std::optional<Options> parseOptions(const int argc, char** argv)
+{
+  try
+  {
+    return parseArguments(argc, argv);
+  }
+  catch (const std::logic_error&)
+  {
+    return std::nullopt;
+  }
+}
+
+
+void printStartupTime(
+  const char* milestone,
+  const std::chrono::high_resolution_clock::duration time)
+{
+  namespace cr = std::chrono;
+
+  std::cerr << "Time to " << milestone << ": "
+    << cr::duration<double, std::milli>{time}.count() << " ms\n";
 }
 
 
@@ -483,11 +839,22 @@ void pumpEvents(sf::Window& window, Game& game)
 } // namespace
 
 
-int main()
+int main(int argc, char** argv)
 {
   namespace cr = std::chrono;
   using Clock = cr::high_resolution_clock;
 
+  const auto startTime = Clock::now();
+
+  const auto options = parseOptions(argc, argv);
+  if (!options)
+  {
+    std::cerr <<
+      "Usage: state_machine [--tick-rate ticks_per_second]\n"
+      "                     [--max-catch-up-steps N]\n";
+    return 1;
+  }
+
   sf::ContextSettings settings;
   settings.antialiasingLevel = 4;
 
@@ -505,7 +872,12 @@ int main()
 
   Game game{window};
 
+  // The simulation always advances in steps of the same size, independent of
+  // the frame rate, which makes it reproducible for identical inputs.
+  FixedTimestep timestep{options->mTickRate, options->mMaxStepsPerFrame};
+
   auto lastFrameTimeStamp = Clock::now();
+  auto hasRenderedFirstFrame = false;
 
   while (window.isOpen())
   {
@@ -515,8 +887,31 @@ int main()
 
     pumpEvents(window, game);
 
-    game.updateAndRender(cr::duration<double>{elapsedTime}.count());
+    const auto numSteps =
+      timestep.advance(cr::duration<double>{elapsedTime}.count());
+    for (auto i = 0; i < numSteps; ++i)
+    {
+      game.update(timestep.stepSize());
+    }
+
+    const auto wasLoaded = game.isLoaded();
+    game.render(timestep.interpolationFactor());
+
+    if (!hasRenderedFirstFrame)
+    {
+      hasRenderedFirstFrame = true;
+      printStartupTime("first frame", Clock::now() - startTime);
+    }
+
+    if (!wasLoaded && game.isLoaded())
+    {
+      printStartupTime("fully loaded", Clock::now() - startTime);
+    }
   }
 
+#ifdef VARIANT_TALK_MATCH_STATISTICS
+  printMatchStatistics(std::cerr);
+#endif
+
   return 0;
 }
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -144,6 +145,30 @@ struct Rect
 };
 
 
+// Same semantics as sf::FloatRect::intersects(): Negative sizes extend the
+// rect to the left/top of topLeft, and rects which only share an edge don't
+// intersect.
+inline bool intersects(const Rect& lhs, const Rect& rhs)
+{
+  using std::max;
+  using std::min;
+
+  const auto lhsEnd = lhs.topLeft + lhs.size;
+  const auto rhsEnd = rhs.topLeft + rhs.size;
+
+  const auto interLeft = max(
+    min(lhs.topLeft.x, lhsEnd.x), min(rhs.topLeft.x, rhsEnd.x));
+  const auto interTop = max(
+    min(lhs.topLeft.y, lhsEnd.y), min(rhs.topLeft.y, rhsEnd.y));
+  const auto interRight = min(
+    max(lhs.topLeft.x, lhsEnd.x), max(rhs.topLeft.x, rhsEnd.x));
+  const auto interBottom = min(
+    max(lhs.topLeft.y, lhsEnd.y), max(rhs.topLeft.y, rhsEnd.y));
+
+  return interLeft < interRight && interTop < interBottom;
+}
+
+
 template <typename Value>
 int roundToInt(Value value)
 {
@@ -0,0 +1,121 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Build time tool which packs the game's resources into a single file (see
+// resource_pack.hpp). Images are decoded here, so that the game doesn't have
+// to at startup.
+//
+// Usage: pack_resources <output file> <input files...>
+//
+// Each resource is named after its input file, without the directory.
+
+#include "resource_pack.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace variant_talk;
+
+
+namespace
+{
+
+bool isImage(const std::filesystem::path& path)
+{
+  const auto extension = path.extension();
+  return extension == ".png" || extension == ".jpg";
+}
+
+
+void addImage(ResourcePackWriter& pack, const std::filesystem::path& path)
+{
+  sf::Image image;
+  if (!image.loadFromFile(path.string()))
+  {
+    throw std::runtime_error{"Cannot decode '" + path.string() + "'"};
+  }
+
+  const auto size = image.getSize();
+  pack.addImage(
+    path.filename().string(), size.x, size.y, image.getPixelsPtr());
+}
+
+
+void addFile(ResourcePackWriter& pack, const std::filesystem::path& path)
+{
+  std::ifstream file{path, std::ios::binary};
+  if (!file)
+  {
+    throw std::runtime_error{"Cannot read '" + path.string() + "'"};
+  }
+
+  const auto contents = std::vector<unsigned char>(
+    std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+  pack.add(path.filename().string(), contents.data(), contents.size());
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: pack_resources <output file> <input files...>\n";
+    return 1;
+  }
+
+  try
+  {
+    ResourcePackWriter pack;
+
+    for (auto i = 2; i < argc; ++i)
+    {
+      const auto path = std::filesystem::path{argv[i]};
+      if (isImage(path))
+      {
+        addImage(pack, path);
+      }
+      else
+      {
+        addFile(pack, path);
+      }
+    }
+
+    pack.write(argv[1]);
+  }
+  catch (const std::exception& error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}
@@ -23,7 +23,6 @@
 
 #include "config.hpp"
 #include "projectiles.hpp"
-#include "sfml_interop.hpp"
 
 #include <algorithm>
 #include <array>
@@ -32,11 +31,9 @@
 namespace variant_talk
 {
 
-Player::Player(
-  ProjectileManager* pProjectiles,
-  ResourceBundle* pResources)
+Player::Player(ProjectileManager* pProjectiles)
   : mpProjectiles(pProjectiles)
-  , mSprite(pResources->mPlayerTextures, 0.08)
+  , mAnimation(NUM_ANIMATION_FRAMES, ANIMATION_FRAME_DELAY)
   , mMovingObject{{125, 280}, {PLAYER_WIDTH, PLAYER_HEIGHT}, {}}
   , mDestructible(MAX_HEALTH, Projectile::Type::Enemy)
 {
@@ -50,19 +47,7 @@ void Player::update(const InputState& input, const double timeDelta)
 
   mpProjectiles->maybeApplyDamage(mDestructible, mMovingObject);
 
-  mSprite.update(timeDelta);
-}
-
-
-void Player::render(sf::RenderWindow& window)
-{
-  const auto offset = mOrientation == Orientation::Left
-    ? Vec2{-(50.0f + PLAYER_WIDTH), 17.0f}
-    : Vec2{50.0f, 17.0f};
-  const auto position = mMovingObject.bbox().topLeft - offset;
-  const auto drawFlipped = mOrientation == Orientation::Left;
-
-  mSprite.render(window, position, drawFlipped);
+  mAnimation.update(timeDelta);
 }
 
 
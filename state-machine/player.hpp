@@ -23,9 +23,6 @@
 
 #include "components.hpp"
 #include "math.hpp"
-#include "resource_bundle.hpp"
-
-#include <SFML/Graphics/RenderWindow.hpp>
 
 
 namespace variant_talk
@@ -51,15 +48,15 @@ enum class Orientation
 class Player
 {
 public:
-  Player(
-    ProjectileManager* pProjectiles,
-    ResourceBundle* pResources);
+  explicit Player(ProjectileManager* pProjectiles);
 
   void update(const InputState& input, const double timeDelta);
-  void render(sf::RenderWindow& window);
 
   int health() const;
   Rect bbox() const;
+  Rect interpolatedBbox(float factor) const;
+  Orientation orientation() const;
+  const Animation& animation() const;
 
 private:
   void updateMovement(const InputState& input, const double timeDelta);
@@ -67,7 +64,7 @@ private:
 
   ProjectileManager* mpProjectiles;
 
-  AnimatedSprite mSprite;
+  Animation mAnimation;
   MovingObject mMovingObject;
   DestructibleObject mDestructible;
 
@@ -87,4 +84,22 @@ inline Rect Player::bbox() const
   return mMovingObject.bbox();
 }
 
+
+inline Rect Player::interpolatedBbox(const float factor) const
+{
+  return mMovingObject.interpolatedBbox(factor);
+}
+
+
+inline Orientation Player::orientation() const
+{
+  return mOrientation;
+}
+
+
+inline const Animation& Player::animation() const
+{
+  return mAnimation;
+}
+
 } // namespace variant_talk
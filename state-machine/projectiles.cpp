@@ -22,9 +22,12 @@
 #include "projectiles.hpp"
 
 #include "config.hpp"
-#include "sfml_interop.hpp"
 
-#include <SFML/Graphics/CircleShape.hpp>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 
 namespace variant_talk
@@ -33,37 +36,185 @@ namespace variant_talk
 namespace
 {
 
-auto findCollidingProjectile(
-  const MovingObject& object,
-  const Projectile::Type affectingType,
-  std::vector<Projectile>& projectiles)
+constexpr auto PROJECTILE_BBOX_SIZE = Vec2{PROJECTILE_SIZE, PROJECTILE_SIZE};
+
+
+struct ProjectileArrays
+{
+  float* mpX;
+  float* mpY;
+  float* mpPreviousX;
+  float* mpPreviousY;
+  const float* mpVelocityX;
+  const float* mpVelocityY;
+  std::uint8_t* mpIsAlive;
+};
+
+
+// Same test as !intersects(screen, bbox), simplified for a positive size.
+// The SIMD versions below must give identical results.
+inline bool isOffScreen(const float x, const float y)
 {
-  using namespace std;
+  return !(
+    x < PLAY_AREA_WIDTH && x + PROJECTILE_SIZE > 0.0f &&
+    y < PLAY_AREA_HEIGHT && y + PROJECTILE_SIZE > 0.0f);
+}
 
-  const auto objectRect = toSfml(object.bbox());
 
-  return find_if(begin(projectiles), end(projectiles),
-    [&](const Projectile& projectile) -> bool
+void integrateAndCull(
+  const ProjectileArrays& arrays,
+  const std::size_t begin,
+  const std::size_t end,
+  const float timeDelta)
+{
+  for (auto i = begin; i < end; ++i)
+  {
+    arrays.mpPreviousX[i] = arrays.mpX[i];
+    arrays.mpPreviousY[i] = arrays.mpY[i];
+    arrays.mpX[i] += arrays.mpVelocityX[i] * timeDelta;
+    arrays.mpY[i] += arrays.mpVelocityY[i] * timeDelta;
+
+    if (isOffScreen(arrays.mpX[i], arrays.mpY[i]))
     {
-      if (projectile.mType == affectingType && !projectile.mIsDestroyed)
-      {
-        const auto projectileRect = toSfml(projectile.mMovingObject.bbox());
-        return objectRect.intersects(projectileRect);
-      }
+      arrays.mpIsAlive[i] = 0;
+    }
+  }
+}
 
-      return false;
-    });
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+
+// Clears the alive flag for each lane set in the off screen mask
+inline void markDead(
+  std::uint8_t* pIsAlive,
+  const std::size_t first,
+  const std::size_t numLanes,
+  const int offScreenMask)
+{
+  if (offScreenMask == 0)
+  {
+    return;
+  }
+
+  for (auto lane = std::size_t{0}; lane < numLanes; ++lane)
+  {
+    if (offScreenMask & (1 << lane))
+    {
+      pIsAlive[first + lane] = 0;
+    }
+  }
 }
 
-} // namespace
 
+#endif
+
+
+#if defined(__AVX__)
 
-bool Projectile::isOffScreen() const
+std::size_t integrateAndCullSimd(
+  const ProjectileArrays& arrays,
+  const std::size_t count,
+  const float timeDelta)
 {
-  const sf::FloatRect screenRect(0, 0, PLAY_AREA_WIDTH, PLAY_AREA_HEIGHT);
-  const auto bboxRect = toSfml(mMovingObject.bbox());
+  constexpr auto LANES = std::size_t{8};
+
+  const auto delta = _mm256_set1_ps(timeDelta);
+  const auto size = _mm256_set1_ps(PROJECTILE_SIZE);
+  const auto zero = _mm256_setzero_ps();
+  const auto width = _mm256_set1_ps(PLAY_AREA_WIDTH);
+  const auto height = _mm256_set1_ps(PLAY_AREA_HEIGHT);
+
+  auto i = std::size_t{0};
+  for (; i + LANES <= count; i += LANES)
+  {
+    const auto x = _mm256_loadu_ps(arrays.mpX + i);
+    const auto y = _mm256_loadu_ps(arrays.mpY + i);
+    _mm256_storeu_ps(arrays.mpPreviousX + i, x);
+    _mm256_storeu_ps(arrays.mpPreviousY + i, y);
+
+    // Separate multiply and add (no FMA), same rounding as the scalar code
+    const auto newX = _mm256_add_ps(
+      x, _mm256_mul_ps(_mm256_loadu_ps(arrays.mpVelocityX + i), delta));
+    const auto newY = _mm256_add_ps(
+      y, _mm256_mul_ps(_mm256_loadu_ps(arrays.mpVelocityY + i), delta));
+    _mm256_storeu_ps(arrays.mpX + i, newX);
+    _mm256_storeu_ps(arrays.mpY + i, newY);
+
+    const auto onScreen = _mm256_and_ps(
+      _mm256_and_ps(
+        _mm256_cmp_ps(newX, width, _CMP_LT_OQ),
+        _mm256_cmp_ps(_mm256_add_ps(newX, size), zero, _CMP_GT_OQ)),
+      _mm256_and_ps(
+        _mm256_cmp_ps(newY, height, _CMP_LT_OQ),
+        _mm256_cmp_ps(_mm256_add_ps(newY, size), zero, _CMP_GT_OQ)));
 
-  return !screenRect.intersects(bboxRect);
+    markDead(arrays.mpIsAlive, i, LANES, ~_mm256_movemask_ps(onScreen) & 0xFF);
+  }
+
+  return i;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+std::size_t integrateAndCullSimd(
+  const ProjectileArrays& arrays,
+  const std::size_t count,
+  const float timeDelta)
+{
+  constexpr auto LANES = std::size_t{4};
+
+  const auto delta = _mm_set1_ps(timeDelta);
+  const auto size = _mm_set1_ps(PROJECTILE_SIZE);
+  const auto zero = _mm_setzero_ps();
+  const auto width = _mm_set1_ps(PLAY_AREA_WIDTH);
+  const auto height = _mm_set1_ps(PLAY_AREA_HEIGHT);
+
+  auto i = std::size_t{0};
+  for (; i + LANES <= count; i += LANES)
+  {
+    const auto x = _mm_loadu_ps(arrays.mpX + i);
+    const auto y = _mm_loadu_ps(arrays.mpY + i);
+    _mm_storeu_ps(arrays.mpPreviousX + i, x);
+    _mm_storeu_ps(arrays.mpPreviousY + i, y);
+
+    const auto newX =
+      _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(arrays.mpVelocityX + i), delta));
+    const auto newY =
+      _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(arrays.mpVelocityY + i), delta));
+    _mm_storeu_ps(arrays.mpX + i, newX);
+    _mm_storeu_ps(arrays.mpY + i, newY);
+
+    const auto onScreen = _mm_and_ps(
+      _mm_and_ps(
+        _mm_cmplt_ps(newX, width),
+        _mm_cmpgt_ps(_mm_add_ps(newX, size), zero)),
+      _mm_and_ps(
+        _mm_cmplt_ps(newY, height),
+        _mm_cmpgt_ps(_mm_add_ps(newY, size), zero)));
+
+    markDead(arrays.mpIsAlive, i, LANES, ~_mm_movemask_ps(onScreen) & 0xF);
+  }
+
+  return i;
+}
+
+#else
+
+std::size_t integrateAndCullSimd(const ProjectileArrays&, std::size_t, float)
+{
+  return 0;
+}
+
+#endif
+
+} // namespace
+
+
+ProjectileManager::ProjectileManager()
+  : mGrid(
+      Rect{{0.0f, 0.0f}, {PLAY_AREA_WIDTH, PLAY_AREA_HEIGHT}},
+      COLLISION_CELL_SIZE)
+{
 }
 
 
@@ -72,13 +223,22 @@ void ProjectileManager::spawnProjectile(
   const Vec2& position,
   const Vec2& movementVec)
 {
-  const auto size = Vec2{PROJECTILE_SIZE, PROJECTILE_SIZE};
   const auto speed = type == Projectile::Type::Player
     ? PLAYER_PROJECTILE_SPEED
     : ENEMY_PROJECTILE_SPEED;
-  mProjectiles.push_back(Projectile{
-    MovingObject{position, size, movementVec * speed},
-    type});
+  const auto velocity = movementVec * speed;
+
+  mX.push_back(position.x);
+  mY.push_back(position.y);
+  mPreviousX.push_back(position.x);
+  mPreviousY.push_back(position.y);
+  mVelocityX.push_back(velocity.x);
+  mVelocityY.push_back(velocity.y);
+  mTypes.push_back(type);
+  mIsAlive.push_back(1);
+
+  const auto index = static_cast<std::uint32_t>(size() - 1);
+  mGrid.insert(index, Rect{position, PROJECTILE_BBOX_SIZE});
 }
 
 
@@ -86,12 +246,36 @@ void ProjectileManager::maybeApplyDamage(
   DestructibleObject& destructible,
   const MovingObject& movingObject)
 {
-  const auto iCollidingProjectile = findCollidingProjectile(
-    movingObject, destructible.affectingType(), mProjectiles);
+  const auto objectRect = movingObject.bbox();
+  const auto affectingType = destructible.affectingType();
+
+  // Pick the first colliding projectile in storage order, like a linear
+  // search would
+  auto firstIndex = size();
+
+  mGrid.forEachCandidate(objectRect,
+    [&](const std::uint32_t index)
+    {
+      if (index >= firstIndex)
+      {
+        return;
+      }
+
+      const auto isHit = mTypes[index] == affectingType &&
+        mIsAlive[index] &&
+        intersects(
+          objectRect,
+          Rect{{mX[index], mY[index]}, PROJECTILE_BBOX_SIZE});
+
+      if (isHit)
+      {
+        firstIndex = index;
+      }
+    });
 
-  if (iCollidingProjectile != std::end(mProjectiles))
+  if (firstIndex != size())
   {
-    iCollidingProjectile->mIsDestroyed = true;
+    mIsAlive[firstIndex] = 0;
     destructible.takeDamage();
   }
 }
@@ -99,39 +283,81 @@ void ProjectileManager::maybeApplyDamage(
 
 void ProjectileManager::update(const double timeDelta)
 {
-  using namespace std;
+  const auto arrays = ProjectileArrays{
+    mX.data(),
+    mY.data(),
+    mPreviousX.data(),
+    mPreviousY.data(),
+    mVelocityX.data(),
+    mVelocityY.data(),
+    mIsAlive.data()};
+  const auto count = size();
+  const auto delta = static_cast<float>(timeDelta);
 
-  for (auto& projectile : mProjectiles)
-  {
-    projectile.update(timeDelta);
-  }
+  const auto numDone = integrateAndCullSimd(arrays, count, delta);
+  integrateAndCull(arrays, numDone, count, delta);
 
-  mProjectiles.erase(
-    remove_if(begin(mProjectiles), end(mProjectiles),
-      [](const Projectile& projectile)
-      {
-        return projectile.isOffScreen() || projectile.mIsDestroyed;
-      }),
-    end(mProjectiles));
+  removeDeadProjectiles();
+  rebuildGrid();
 }
 
 
-void ProjectileManager::render(sf::RenderWindow& window)
+Projectile ProjectileManager::projectile(const std::size_t index) const
 {
-  for (auto& projectile : mProjectiles)
+  return Projectile{
+    {mX[index], mY[index]},
+    {mPreviousX[index], mPreviousY[index]},
+    {mVelocityX[index], mVelocityY[index]},
+    mTypes[index],
+    !mIsAlive[index]};
+}
+
+
+void ProjectileManager::removeDeadProjectiles()
+{
+  auto count = size();
+
+  for (auto i = std::size_t{0}; i < count;)
   {
-    if (projectile.mIsDestroyed)
+    if (mIsAlive[i])
     {
+      ++i;
       continue;
     }
 
-    sf::CircleShape shape{PROJECTILE_RADIUS};
-    shape.setFillColor(projectile.mType == Projectile::Type::Player
-      ? sf::Color{0, 255, 0}
-      : sf::Color{255, 0, 0});
-    shape.setPosition(toSfml(projectile.mMovingObject.bbox().topLeft));
+    --count;
+    mX[i] = mX[count];
+    mY[i] = mY[count];
+    mPreviousX[i] = mPreviousX[count];
+    mPreviousY[i] = mPreviousY[count];
+    mVelocityX[i] = mVelocityX[count];
+    mVelocityY[i] = mVelocityY[count];
+    mTypes[i] = mTypes[count];
+    mIsAlive[i] = mIsAlive[count];
+  }
+
+  mX.resize(count);
+  mY.resize(count);
+  mPreviousX.resize(count);
+  mPreviousY.resize(count);
+  mVelocityX.resize(count);
+  mVelocityY.resize(count);
+  mTypes.resize(count);
+  mIsAlive.resize(count);
+}
+
 
-    window.draw(shape);
+void ProjectileManager::rebuildGrid()
+{
+  // Removing projectiles moves others into their slots, and all remaining
+  // ones have moved, so it's cheapest to start over
+  mGrid.clear();
+
+  for (auto i = std::size_t{0}; i < size(); ++i)
+  {
+    mGrid.insert(
+      static_cast<std::uint32_t>(i),
+      Rect{{mX[i], mY[i]}, PROJECTILE_BBOX_SIZE});
   }
 }
 
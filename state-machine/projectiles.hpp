@@ -23,18 +23,32 @@
 
 #include "components.hpp"
 #include "math.hpp"
+#include "spatial_grid.hpp"
 
-#include <SFML/Graphics/RenderWindow.hpp>
-
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 
 namespace variant_talk
 {
 
+// Owns all projectiles, and tests them for collisions.
+//
+// Projectiles are stored as structure of arrays, so that moving them and
+// removing those which left the play area can be done several at a time with
+// SIMD instructions. Dead projectiles are removed by moving the last one into
+// their slot, so the order of projectiles changes over time.
+//
+// A spatial grid over the play area keeps track of which projectiles are
+// where, so that collision tests only need to look at the projectiles near
+// the tested object. The grid is rebuilt as part of update(), and newly
+// spawned projectiles are added to it right away.
 class ProjectileManager
 {
 public:
+  ProjectileManager();
+
   void spawnProjectile(
     const Projectile::Type type,
     const Vec2& position,
@@ -48,10 +62,30 @@ public:
     const MovingObject& movingObject);
 
   void update(const double timeDelta);
-  void render(sf::RenderWindow& window);
+
+  std::size_t size() const;
+  Projectile projectile(std::size_t index) const;
 
 private:
-  std::vector<Projectile> mProjectiles;
+  void removeDeadProjectiles();
+  void rebuildGrid();
+
+  std::vector<float> mX;
+  std::vector<float> mY;
+  std::vector<float> mPreviousX;
+  std::vector<float> mPreviousY;
+  std::vector<float> mVelocityX;
+  std::vector<float> mVelocityY;
+  std::vector<Projectile::Type> mTypes;
+  std::vector<std::uint8_t> mIsAlive;
+
+  SpatialGrid mGrid;
 };
 
+
+inline std::size_t ProjectileManager::size() const
+{
+  return mX.size();
+}
+
 } // namespace variant_talk
@@ -0,0 +1,253 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rendering.hpp"
+
+#include "config.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+constexpr auto CIRCLE_TEXTURE_SIZE = 32u;
+constexpr auto VERTICES_PER_QUAD = std::size_t{6};
+
+
+void renderAnimationFrame(
+  SpriteBatch& batch,
+  const ResourceBundle& resources,
+  const std::array<TextureAtlas::ImageId, NUM_ANIMATION_FRAMES>& frames,
+  const Animation& animation,
+  const Rect& bbox,
+  const bool facingLeft)
+{
+  const auto& region =
+    resources.mAtlas.region(frames[animation.frameIndex()]);
+
+  // The frames are wider than the ship's bounding box, which only covers its
+  // body. When facing left, the frame is mirrored around the anchor point.
+  const auto anchor = facingLeft
+    ? bbox.topLeft + Vec2{50.0f + PLAYER_WIDTH, -17.0f}
+    : bbox.topLeft - Vec2{50.0f, 17.0f};
+  const auto topLeft = facingLeft
+    ? anchor - Vec2{static_cast<float>(region.width), 0.0f}
+    : anchor;
+
+  batch.add(region, topLeft, facingLeft);
+}
+
+} // namespace
+
+
+SpriteBatch::SpriteBatch(const sf::Texture& texture)
+  : mpTexture(&texture)
+  , mVertices(sf::Triangles)
+{
+}
+
+
+void SpriteBatch::add(
+  const sf::IntRect& textureRegion,
+  const Vec2& topLeft,
+  const bool flipHorizontally)
+{
+  const auto size = Vec2{
+    static_cast<float>(textureRegion.width),
+    static_cast<float>(textureRegion.height)};
+  const auto bottomRight = topLeft + size;
+
+  auto textureLeft = static_cast<float>(textureRegion.left);
+  auto textureRight = textureLeft + size.x;
+  const auto textureTop = static_cast<float>(textureRegion.top);
+  const auto textureBottom = textureTop + size.y;
+
+  if (flipHorizontally)
+  {
+    std::swap(textureLeft, textureRight);
+  }
+
+  const auto corners = std::array<sf::Vertex, 4>{
+    sf::Vertex{{topLeft.x, topLeft.y}, {textureLeft, textureTop}},
+    sf::Vertex{{bottomRight.x, topLeft.y}, {textureRight, textureTop}},
+    sf::Vertex{
+      {bottomRight.x, bottomRight.y}, {textureRight, textureBottom}},
+    sf::Vertex{{topLeft.x, bottomRight.y}, {textureLeft, textureBottom}}};
+
+  // Two triangles per quad
+  for (const auto corner : {0, 1, 2, 0, 2, 3})
+  {
+    mVertices.append(corners[corner]);
+  }
+}
+
+
+void SpriteBatch::draw(sf::RenderTarget& target)
+{
+  if (mVertices.getVertexCount() > 0)
+  {
+    target.draw(mVertices, sf::RenderStates{mpTexture});
+  }
+
+  // Keeps the allocation around for the next frame
+  mVertices.clear();
+}
+
+
+void render(
+  SpriteBatch& batch,
+  const Player& player,
+  const ResourceBundle& resources,
+  const float interpolation)
+{
+  renderAnimationFrame(
+    batch,
+    resources,
+    resources.mPlayerFrames,
+    player.animation(),
+    player.interpolatedBbox(interpolation),
+    player.orientation() == Orientation::Left);
+}
+
+
+void render(
+  SpriteBatch& batch,
+  const Enemy& enemy,
+  const ResourceBundle& resources,
+  const float interpolation)
+{
+  renderAnimationFrame(
+    batch,
+    resources,
+    resources.mOpponentFrames,
+    enemy.animation(),
+    enemy.interpolatedBbox(interpolation),
+    enemy.isFacingLeft());
+}
+
+
+ProjectileRenderer::ProjectileRenderer()
+  : mVertices(sf::Triangles)
+{
+  // Anti-aliased white disc, scaled down to the projectile size when drawn
+  std::array<sf::Uint8, CIRCLE_TEXTURE_SIZE * CIRCLE_TEXTURE_SIZE * 4> pixels;
+
+  const auto center = CIRCLE_TEXTURE_SIZE / 2.0f;
+  for (auto y = 0u; y < CIRCLE_TEXTURE_SIZE; ++y)
+  {
+    for (auto x = 0u; x < CIRCLE_TEXTURE_SIZE; ++x)
+    {
+      const auto pixelCenter = Vec2{x + 0.5f, y + 0.5f};
+      const auto distanceToEdge =
+        center - distance(pixelCenter, Vec2{center, center});
+      const auto coverage = std::clamp(distanceToEdge, 0.0f, 1.0f);
+
+      const auto offset = (y * CIRCLE_TEXTURE_SIZE + x) * 4;
+      pixels[offset] = 255;
+      pixels[offset + 1] = 255;
+      pixels[offset + 2] = 255;
+      pixels[offset + 3] = static_cast<sf::Uint8>(roundToInt(coverage * 255));
+    }
+  }
+
+  sf::Image image;
+  image.create(CIRCLE_TEXTURE_SIZE, CIRCLE_TEXTURE_SIZE, pixels.data());
+  mCircleTexture.loadFromImage(image);
+  mCircleTexture.setSmooth(true);
+}
+
+
+void ProjectileRenderer::render(
+  sf::RenderWindow& window,
+  const ProjectileManager& projectiles,
+  const float interpolation)
+{
+  constexpr auto TEXTURE_SIZE = static_cast<float>(CIRCLE_TEXTURE_SIZE);
+
+  mVertices.resize(projectiles.size() * VERTICES_PER_QUAD);
+
+  auto numVertices = std::size_t{0};
+  for (auto i = std::size_t{0}; i < projectiles.size(); ++i)
+  {
+    const auto projectile = projectiles.projectile(i);
+    if (projectile.mIsDestroyed)
+    {
+      continue;
+    }
+
+    const auto color = projectile.mType == Projectile::Type::Player
+      ? sf::Color{0, 255, 0}
+      : sf::Color{255, 0, 0};
+    const auto bbox = projectile.interpolatedBbox(interpolation);
+    const auto topLeft = bbox.topLeft;
+    const auto bottomRight = bbox.topLeft + bbox.size;
+
+    const auto corners = std::array<sf::Vertex, 4>{
+      sf::Vertex{{topLeft.x, topLeft.y}, color, {0.0f, 0.0f}},
+      sf::Vertex{{bottomRight.x, topLeft.y}, color, {TEXTURE_SIZE, 0.0f}},
+      sf::Vertex{
+        {bottomRight.x, bottomRight.y}, color, {TEXTURE_SIZE, TEXTURE_SIZE}},
+      sf::Vertex{{topLeft.x, bottomRight.y}, color, {0.0f, TEXTURE_SIZE}}};
+
+    // Two triangles per quad
+    for (const auto corner : {0, 1, 2, 0, 2, 3})
+    {
+      mVertices[numVertices++] = corners[corner];
+    }
+  }
+
+  mVertices.resize(numVertices);
+
+  if (numVertices > 0)
+  {
+    window.draw(mVertices, sf::RenderStates{&mCircleTexture});
+  }
+}
+
+
+void render(
+  sf::RenderWindow& window,
+  const GameWorld& world,
+  const ResourceBundle& resources,
+  SpriteBatch& spriteBatch,
+  ProjectileRenderer& projectileRenderer,
+  const float interpolation)
+{
+  render(spriteBatch, world.mPlayer, resources, interpolation);
+  render(spriteBatch, world.mEnemy, resources, interpolation);
+  spriteBatch.draw(window);
+
+  projectileRenderer.render(window, world.mProjectiles, interpolation);
+}
+
+} // namespace variant_talk
@@ -0,0 +1,108 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "game_world.hpp"
+#include "resource_bundle.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+
+namespace variant_talk
+{
+
+// Drawing of the game world. Kept apart from the simulation, so that the
+// latter can be built and run without SFML (see headless_main.cpp).
+//
+// Moving objects are drawn in between their positions before and after the
+// last simulation step, as given by the interpolation factor (see
+// FixedTimestep).
+
+// Collects textured quads which all use the same texture (normally an atlas,
+// see TextureAtlas), and draws them with a single draw call. The vertex array
+// is reused from frame to frame.
+class SpriteBatch
+{
+public:
+  explicit SpriteBatch(const sf::Texture& texture);
+
+  // Adds a quad showing the given region of the texture, with its top left
+  // corner at the given position. When flipped, the region is mirrored
+  // horizontally within the quad.
+  void add(
+    const sf::IntRect& textureRegion,
+    const Vec2& topLeft,
+    bool flipHorizontally);
+
+  // Draws all quads added since the last call, and clears the batch.
+  void draw(sf::RenderTarget& target);
+
+private:
+  const sf::Texture* mpTexture;
+  sf::VertexArray mVertices;
+};
+
+
+void render(
+  SpriteBatch& batch,
+  const Player& player,
+  const ResourceBundle& resources,
+  float interpolation);
+
+void render(
+  SpriteBatch& batch,
+  const Enemy& enemy,
+  const ResourceBundle& resources,
+  float interpolation);
+
+// Draws all projectiles with a single draw call: Each one is a quad textured
+// with a circle, colored by type via the vertex colors, and all quads go into
+// the same vertex array. The array is reused from frame to frame.
+class ProjectileRenderer
+{
+public:
+  ProjectileRenderer();
+
+  void render(
+    sf::RenderWindow& window,
+    const ProjectileManager& projectiles,
+    float interpolation);
+
+private:
+  sf::Texture mCircleTexture;
+  sf::VertexArray mVertices;
+};
+
+
+void render(
+  sf::RenderWindow& window,
+  const GameWorld& world,
+  const ResourceBundle& resources,
+  SpriteBatch& spriteBatch,
+  ProjectileRenderer& projectileRenderer,
+  float interpolation);
+
+} // namespace variant_talk
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <SFML/Graphics/Texture.hpp>
+#include "config.hpp"
+#include "texture_atlas.hpp"
 
 #include <array>
 
@@ -8,10 +9,13 @@
 namespace variant_talk
 {
 
+// All animation frames live in one atlas, and are referred to by their id
+// within it.
 struct ResourceBundle
 {
-  std::array<sf::Texture, 2> mPlayerTextures;
-  std::array<sf::Texture, 2> mOpponentTextures;
+  TextureAtlas mAtlas;
+  std::array<TextureAtlas::ImageId, NUM_ANIMATION_FRAMES> mPlayerFrames;
+  std::array<TextureAtlas::ImageId, NUM_ANIMATION_FRAMES> mOpponentFrames;
 };
 
 } // namespace variant_talk
@@ -0,0 +1,220 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "resource_pack.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+using detail::RESOURCE_PACK_ALIGNMENT;
+using detail::RESOURCE_PACK_MAGIC;
+using detail::ResourcePackEntry;
+
+constexpr auto INDEX_OFFSET =
+  sizeof(RESOURCE_PACK_MAGIC) + sizeof(std::uint32_t);
+
+
+std::size_t alignUp(const std::size_t offset)
+{
+  return (offset + RESOURCE_PACK_ALIGNMENT - 1) / RESOURCE_PACK_ALIGNMENT *
+    RESOURCE_PACK_ALIGNMENT;
+}
+
+
+std::uint32_t readNumEntries(const MappedFile& file)
+{
+  std::uint32_t numEntries;
+  std::memcpy(
+    &numEntries, file.data() + sizeof(RESOURCE_PACK_MAGIC), sizeof(numEntries));
+  return numEntries;
+}
+
+
+ResourcePackEntry readEntry(const MappedFile& file, const std::size_t index)
+{
+  ResourcePackEntry entry;
+  std::memcpy(
+    &entry,
+    file.data() + INDEX_OFFSET + index * sizeof(ResourcePackEntry),
+    sizeof(entry));
+  return entry;
+}
+
+
+bool isValid(const MappedFile& file)
+{
+  if (
+    file.size() < INDEX_OFFSET ||
+    std::memcmp(file.data(), RESOURCE_PACK_MAGIC, sizeof(RESOURCE_PACK_MAGIC))
+      != 0)
+  {
+    return false;
+  }
+
+  const auto numEntries = readNumEntries(file);
+  if ((file.size() - INDEX_OFFSET) / sizeof(ResourcePackEntry) < numEntries)
+  {
+    return false;
+  }
+
+  for (auto i = std::size_t{0}; i < numEntries; ++i)
+  {
+    const auto entry = readEntry(file, i);
+
+    const auto hasValidName =
+      std::memchr(entry.mName, '\0', sizeof(entry.mName)) != nullptr;
+    const auto isInBounds =
+      entry.mOffset <= file.size() &&
+      entry.mSize <= file.size() - entry.mOffset;
+    const auto isImage = entry.mWidth != 0;
+    const auto hasValidSize = !isImage ||
+      entry.mSize == std::uint64_t{entry.mWidth} * entry.mHeight * 4;
+
+    if (!hasValidName || !isInBounds || !hasValidSize)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+
+void ResourcePackWriter::add(
+  std::string name,
+  const unsigned char* pData,
+  const std::size_t size)
+{
+  mResources.push_back(
+    Resource{std::move(name), std::vector<unsigned char>(pData, pData + size)});
+}
+
+
+void ResourcePackWriter::addImage(
+  std::string name,
+  const unsigned width,
+  const unsigned height,
+  const unsigned char* pPixels)
+{
+  const auto size = std::size_t{width} * height * 4;
+  mResources.push_back(Resource{
+    std::move(name),
+    std::vector<unsigned char>(pPixels, pPixels + size),
+    width,
+    height});
+}
+
+
+void ResourcePackWriter::write(const std::string& path) const
+{
+  auto index = std::vector<ResourcePackEntry>{};
+  auto offset = alignUp(
+    INDEX_OFFSET + mResources.size() * sizeof(ResourcePackEntry));
+
+  for (const auto& resource : mResources)
+  {
+    auto entry = ResourcePackEntry{};
+    if (resource.mName.size() >= sizeof(entry.mName))
+    {
+      throw std::runtime_error{
+        "Resource name '" + resource.mName + "' is too long"};
+    }
+
+    std::memcpy(entry.mName, resource.mName.data(), resource.mName.size());
+    entry.mWidth = resource.mWidth;
+    entry.mHeight = resource.mHeight;
+    entry.mOffset = offset;
+    entry.mSize = resource.mData.size();
+    index.push_back(entry);
+
+    offset = alignUp(offset + resource.mData.size());
+  }
+
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+  const auto numEntries = static_cast<std::uint32_t>(index.size());
+  file.write(RESOURCE_PACK_MAGIC, sizeof(RESOURCE_PACK_MAGIC));
+  file.write(reinterpret_cast<const char*>(&numEntries), sizeof(numEntries));
+  file.write(
+    reinterpret_cast<const char*>(index.data()),
+    index.size() * sizeof(ResourcePackEntry));
+
+  for (auto i = std::size_t{0}; i < mResources.size(); ++i)
+  {
+    const auto& data = mResources[i].mData;
+
+    // Padding up to the start of the entry
+    const auto position = static_cast<std::uint64_t>(file.tellp());
+    const auto padding = std::vector<char>(index[i].mOffset - position, '\0');
+    file.write(padding.data(), padding.size());
+
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+
+  if (!file)
+  {
+    throw std::runtime_error{"Cannot write resource pack '" + path + "'"};
+  }
+}
+
+
+ResourcePackReader::ResourcePackReader(const std::string& path)
+  : mFile(path)
+{
+  if (!isValid(mFile))
+  {
+    throw std::runtime_error{"'" + path + "' is not a valid resource pack"};
+  }
+}
+
+
+PackedResource ResourcePackReader::get(const std::string_view name) const
+{
+  const auto numEntries = readNumEntries(mFile);
+  for (auto i = std::size_t{0}; i < numEntries; ++i)
+  {
+    const auto entry = readEntry(mFile, i);
+    if (name == entry.mName)
+    {
+      return PackedResource{
+        mFile.data() + entry.mOffset,
+        static_cast<std::size_t>(entry.mSize),
+        entry.mWidth,
+        entry.mHeight};
+    }
+  }
+
+  throw std::runtime_error{
+    "Resource '" + std::string{name} + "' is missing from the pack"};
+}
+
+} // namespace variant_talk
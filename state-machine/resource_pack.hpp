@@ -0,0 +1,126 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Single file holding all of the game's resources, in a form which can be
+// used without any decoding. Images are stored as raw RGBA pixels, ready to
+// be uploaded to a texture, everything else (e.g. fonts) as is. The pack is
+// created at build time by pack_resources.cpp.
+//
+// The file starts with an 8 byte header (magic and format version), followed
+// by the number of entries as a 32 bit integer and an index with one
+// detail::ResourcePackEntry per resource. The contents follow the index,
+// each one starting at a 16 byte boundary. Integers use the host's byte order,
+// so packs are only portable between machines which agree on it.
+
+// A resource within a pack. Points into the pack's memory mapping, so it's
+// only valid as long as the ResourcePackReader it came from.
+struct PackedResource
+{
+  const unsigned char* mpData = nullptr;
+  std::size_t mSize = 0;
+
+  // Zero unless the resource is an image
+  unsigned mWidth = 0;
+  unsigned mHeight = 0;
+};
+
+
+class ResourcePackWriter
+{
+public:
+  void add(std::string name, const unsigned char* pData, std::size_t size);
+
+  // Expects width * height pixels with 4 bytes each, in RGBA order.
+  void addImage(
+    std::string name,
+    unsigned width,
+    unsigned height,
+    const unsigned char* pPixels);
+
+  // Throws std::runtime_error if the file can't be written, or if a name is
+  // too long.
+  void write(const std::string& path) const;
+
+private:
+  struct Resource
+  {
+    std::string mName;
+    std::vector<unsigned char> mData;
+    unsigned mWidth = 0;
+    unsigned mHeight = 0;
+  };
+
+  std::vector<Resource> mResources;
+};
+
+
+// Gives access to the resources in a pack, on top of a memory mapping of the
+// file. Nothing is copied, the OS only reads the parts which are used.
+class ResourcePackReader
+{
+public:
+  // Throws std::runtime_error if the file can't be mapped, or isn't a valid
+  // resource pack.
+  explicit ResourcePackReader(const std::string& path);
+
+  // Throws std::runtime_error if there is no resource with the given name.
+  PackedResource get(std::string_view name) const;
+
+private:
+  MappedFile mFile;
+};
+
+
+namespace detail
+{
+
+inline constexpr char RESOURCE_PACK_MAGIC[8] =
+  {'V', 'T', 'R', 'E', 'S', 'P', 'K', 1};
+
+inline constexpr std::size_t RESOURCE_PACK_ALIGNMENT = 16;
+
+
+struct ResourcePackEntry
+{
+  char mName[48]; // null terminated
+  std::uint32_t mWidth;
+  std::uint32_t mHeight;
+  std::uint64_t mOffset; // from the start of the file
+  std::uint64_t mSize;
+};
+
+} // namespace detail
+
+} // namespace variant_talk
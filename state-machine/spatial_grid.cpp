@@ -0,0 +1,88 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "spatial_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace variant_talk
+{
+
+SpatialGrid::SpatialGrid(const Rect& area, const float cellSize)
+  : mOrigin(area.topLeft)
+  , mInverseCellSize(1.0f / cellSize)
+  , mNumColumns(std::max(roundToInt(std::ceil(area.size.x / cellSize)), 1))
+  , mNumRows(std::max(roundToInt(std::ceil(area.size.y / cellSize)), 1))
+  , mCells(static_cast<std::size_t>(mNumColumns * mNumRows))
+{
+}
+
+
+void SpatialGrid::clear()
+{
+  for (auto& cell : mCells)
+  {
+    cell.clear();
+  }
+}
+
+
+void SpatialGrid::insert(const std::uint32_t index, const Rect& bbox)
+{
+  const auto range = cellRange(bbox);
+
+  for (auto row = range.mFirstRow; row <= range.mLastRow; ++row)
+  {
+    const auto rowStart = row * mNumColumns;
+
+    for (auto column = range.mFirstColumn;
+      column <= range.mLastColumn;
+      ++column)
+    {
+      mCells[rowStart + column].push_back(index);
+    }
+  }
+}
+
+
+SpatialGrid::CellRange SpatialGrid::cellRange(const Rect& bbox) const
+{
+  // Truncating instead of rounding down only makes a difference for negative
+  // coordinates, which end up in cell 0 either way
+  const auto toCell = [this](const float coordinate, const int numCells)
+  {
+    const auto cell = static_cast<int>(coordinate * mInverseCellSize);
+    return std::clamp(cell, 0, numCells - 1);
+  };
+
+  const auto start = bbox.topLeft - mOrigin;
+  const auto end = start + bbox.size;
+
+  return CellRange{
+    toCell(std::min(start.x, end.x), mNumColumns),
+    toCell(std::max(start.x, end.x), mNumColumns),
+    toCell(std::min(start.y, end.y), mNumRows),
+    toCell(std::max(start.y, end.y), mNumRows)};
+}
+
+} // namespace variant_talk
@@ -0,0 +1,97 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "math.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Uniform grid broadphase. Maps each cell to the indices of the objects whose
+// bounding boxes overlap it, so that a query only needs to look at objects
+// close to the queried rect.
+//
+// Objects outside of the grid's area are treated as if they were in the
+// nearest border cell, so queries still find them.
+class SpatialGrid
+{
+public:
+  SpatialGrid(const Rect& area, float cellSize);
+
+  // Keeps the cells' memory around for the next rebuild
+  void clear();
+
+  void insert(std::uint32_t index, const Rect& bbox);
+
+  // Invokes callback with the index of each object which might intersect the
+  // given rect. Objects overlapping more than one of the rect's cells are
+  // reported once per cell.
+  template <typename Callback>
+  void forEachCandidate(const Rect& bbox, Callback&& callback) const;
+
+private:
+  struct CellRange
+  {
+    int mFirstColumn;
+    int mLastColumn;
+    int mFirstRow;
+    int mLastRow;
+  };
+
+  CellRange cellRange(const Rect& bbox) const;
+
+  Vec2 mOrigin;
+  float mInverseCellSize;
+  int mNumColumns;
+  int mNumRows;
+  std::vector<std::vector<std::uint32_t>> mCells;
+};
+
+
+template <typename Callback>
+void SpatialGrid::forEachCandidate(
+  const Rect& bbox,
+  Callback&& callback) const
+{
+  const auto range = cellRange(bbox);
+
+  for (auto row = range.mFirstRow; row <= range.mLastRow; ++row)
+  {
+    const auto rowStart = row * mNumColumns;
+
+    for (auto column = range.mFirstColumn;
+      column <= range.mLastColumn;
+      ++column)
+    {
+      for (const auto index : mCells[rowStart + column])
+      {
+        callback(index);
+      }
+    }
+  }
+}
+
+} // namespace variant_talk
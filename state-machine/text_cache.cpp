@@ -0,0 +1,77 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "text_cache.hpp"
+
+#include <utility>
+
+
+namespace variant_talk
+{
+
+TextCache::TextCache(const sf::Font& font)
+  : mpFont(&font)
+{
+}
+
+
+const sf::Text& TextCache::get(
+  const std::string_view string,
+  const unsigned characterSize,
+  const sf::Color& color)
+{
+  const auto colorValue = color.toInteger();
+
+  const auto iText =
+    mTexts.find(std::make_tuple(string, characterSize, colorValue));
+  if (iText != mTexts.end())
+  {
+    return iText->second;
+  }
+
+  if (mTexts.size() >= MAX_ENTRIES)
+  {
+    mTexts.clear();
+  }
+
+  sf::Text text;
+  text.setFont(*mpFont);
+  text.setCharacterSize(characterSize);
+  text.setFillColor(color);
+  text.setString(std::string(string));
+
+  auto key = Key{std::string(string), characterSize, colorValue};
+  return mTexts.emplace(std::move(key), std::move(text)).first->second;
+}
+
+
+void TextCache::prewarm(
+  const std::string_view characters,
+  const unsigned characterSize) const
+{
+  for (const auto character : characters)
+  {
+    const auto codePoint = static_cast<unsigned char>(character);
+    mpFont->getGlyph(codePoint, characterSize, false);
+  }
+}
+
+} // namespace variant_talk
@@ -0,0 +1,77 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+
+namespace variant_talk
+{
+
+// Keeps laid out texts around between frames.
+//
+// sf::Text only computes the vertices for its glyphs when its string, font or
+// character size change. Handing out the same sf::Text for the same string,
+// size and color every frame thus skips the layout, as well as the string
+// copies needed to set up a new sf::Text. Lookups don't allocate.
+//
+// Meant for a limited set of strings. When the number of cached texts exceeds
+// MAX_ENTRIES, the cache starts over.
+class TextCache
+{
+public:
+  static constexpr auto MAX_ENTRIES = std::size_t{256};
+
+  explicit TextCache(const sf::Font& font);
+
+  TextCache(const TextCache&) = delete;
+  TextCache& operator=(const TextCache&) = delete;
+
+  // Returns the text for the given parameters, creating it on first use. The
+  // text is positioned at the origin.
+  const sf::Text& get(
+    std::string_view string,
+    unsigned characterSize,
+    const sf::Color& color);
+
+  // Rasterizes the glyphs for the given characters in advance, so that the
+  // first frame showing them doesn't have to. Must be called after the font
+  // has been loaded.
+  void prewarm(std::string_view characters, unsigned characterSize) const;
+
+private:
+  using Key = std::tuple<std::string, unsigned, sf::Uint32>;
+
+  const sf::Font* mpFont;
+  std::map<Key, sf::Text, std::less<>> mTexts;
+};
+
+} // namespace variant_talk
@@ -0,0 +1,122 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "texture_atlas.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+
+namespace variant_talk
+{
+
+namespace
+{
+
+constexpr auto PADDING = 2u;
+constexpr auto MIN_ATLAS_WIDTH = 512u;
+
+} // namespace
+
+
+TextureAtlas::ImageId TextureAtlas::add(const sf::Image& image)
+{
+  assert(mRegions.empty());
+
+  mPendingImages.push_back(image);
+  return mPendingImages.size() - 1;
+}
+
+
+void TextureAtlas::pack()
+{
+  auto order = std::vector<ImageId>(mPendingImages.size());
+  std::iota(order.begin(), order.end(), ImageId{0});
+  std::stable_sort(order.begin(), order.end(),
+    [this](const ImageId lhs, const ImageId rhs)
+    {
+      return mPendingImages[lhs].getSize().y > mPendingImages[rhs].getSize().y;
+    });
+
+  auto widestImage = 0u;
+  for (const auto& image : mPendingImages)
+  {
+    widestImage = std::max(widestImage, image.getSize().x);
+  }
+
+  const auto atlasWidth = std::max(widestImage + 2 * PADDING, MIN_ATLAS_WIDTH);
+
+  mRegions.resize(mPendingImages.size());
+
+  auto x = PADDING;
+  auto y = PADDING;
+  auto shelfHeight = 0u;
+  for (const auto id : order)
+  {
+    const auto size = mPendingImages[id].getSize();
+    if (x + size.x + PADDING > atlasWidth)
+    {
+      x = PADDING;
+      y += shelfHeight + PADDING;
+      shelfHeight = 0u;
+    }
+
+    mRegions[id] = sf::IntRect{
+      static_cast<int>(x),
+      static_cast<int>(y),
+      static_cast<int>(size.x),
+      static_cast<int>(size.y)};
+
+    x += size.x + PADDING;
+    shelfHeight = std::max(shelfHeight, size.y);
+  }
+
+  sf::Image atlas;
+  atlas.create(atlasWidth, y + shelfHeight + PADDING, sf::Color::Transparent);
+
+  for (auto id = ImageId{0}; id < mPendingImages.size(); ++id)
+  {
+    atlas.copy(
+      mPendingImages[id],
+      static_cast<unsigned>(mRegions[id].left),
+      static_cast<unsigned>(mRegions[id].top));
+  }
+
+  mTexture.loadFromImage(atlas);
+
+  // The pixels live in the texture now
+  mPendingImages = {};
+}
+
+
+const sf::Texture& TextureAtlas::texture() const
+{
+  return mTexture;
+}
+
+
+const sf::IntRect& TextureAtlas::region(const ImageId id) const
+{
+  return mRegions[id];
+}
+
+} // namespace variant_talk
@@ -0,0 +1,61 @@
+/* Copyright (C) 2018, Nikolai Wuttke. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+namespace variant_talk
+{
+
+// Packs many small images into a single texture, so that everything drawn
+// from them can share one texture bind and one draw call (see SpriteBatch).
+//
+// Usage: add() all images, then pack() once. add() returns an id, which can
+// be used to look up the image's region within texture() after packing.
+//
+// Images are placed on shelves sorted by height, with a bit of transparent
+// padding around each one, so that neighbouring images don't bleed into
+// each other when drawn at fractional positions.
+class TextureAtlas
+{
+public:
+  using ImageId = std::size_t;
+
+  ImageId add(const sf::Image& image);
+  void pack();
+
+  const sf::Texture& texture() const;
+  const sf::IntRect& region(ImageId id) const;
+
+private:
+  std::vector<sf::Image> mPendingImages;
+  std::vector<sf::IntRect> mRegions;
+  sf::Texture mTexture;
+};
+
+} // namespace variant_talk